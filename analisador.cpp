@@ -1,282 +1,501 @@
-// Compiladores 2025.1 - Analisador Lexico
-
-// No linux:
-// Compilar com: g++ -o analisador analisador.cpp
-// Executar com: ./analisador arquivo.txt
-
-// No windows:
-// Compilar com: g++ analisador.cpp
-// Executar com: .\a arquivo.txt
-
-// Bibliotecas utilizadas
-#include <iostream>     // entrada e saida (cout, cerr)
-#include <fstream>      // manipulacao de arquivos (ifstream)
-#include <cctype>       // funcoes de verificacao de caracteres (isalpha, isdigit)
-#include <string>       // manipulacao de strings
-#include <vector>       // lista de palavras reservadas
-#include <algorithm>    // uso em intervalos de elementos (transform)
-
-using namespace std;    // evita usar std:: a cada chamada
-
-// palavras reservadas da linguagem
-const vector<string> palavras_reservadas = {
-    "if", "else", "while", "break", "print", "readln", "return",
-    "int", "float", "char", "bool", "true", "false"
-};
-
-// verifica se uma palavra eh reservada
-bool is_palavra_reservada(const string& palavra){
-    for (const auto& reservada : palavras_reservadas){
-        if (palavra == reservada)
-            return true;
-    }
-    return false;
-}
-
-// transforma uma string para maiusculas (estilo Linux/portavel)
-string strupr_linux(string str){
-    transform(str.begin(), str.end(), str.begin(), ::toupper);
-    return str;
-}
-
-// realiza a analise lexica
-void analisar(ifstream& arquivo){
-    char c;         // Caractere atual
-    string token;   // Token em construcao
-    int linha = 1;
-    int coluna = 0;
-
-    while (arquivo.get(c)){
-        if (c == '\n'){
-            linha++;
-            coluna = 0;
-            continue;
-        }
-
-        // ignora espacos, tabs e quebras de linha
-        if (isspace(c)) {
-            coluna++;
-            continue;
-        }
-
-        // Ignorando comentários do tipo /* comentário */
-        if (c == '/') {
-            char proximo;
-            if (arquivo.get(proximo)) {
-                if (proximo == '*') {
-                    // início do comentário de bloco
-                    coluna += 2;
-                    char anterior = 0;
-                    while (arquivo.get(c)) {
-                        coluna++;
-                        if (c == '\n') {
-                            linha++;
-                            coluna = 0;
-                        }
-                        if (anterior == '*' && c == '/') {
-                            coluna++; // quando fecha comentário
-                            break; // quando sai do comentário
-                        }
-                        anterior = c;
-                    }
-                    continue; // volta ao início do loop, ignora tudo do comentário
-                } else {
-                    // quando não é comentário, é um operador de divisão normal
-                    arquivo.unget(); // Devolve o caractere lido
-                }
-            }
-        }
-
-        // Identificadores ou palavras reservadas (comecam com letra ou '_')
-        if(isalpha(c) || c == '_'){
-            token = c;
-            coluna++; // incremento para o primeiro caractere do token
-
-            while (arquivo.get(c) && (isalnum(c) || c == '_')){
-                token += c;
-                coluna++; // incremento para cada caractere seguinte
-            }
-
-            if (arquivo) arquivo.unget(); // Devolve o ultimo caractere lido se nao for parte do token
-
-            if (is_palavra_reservada(token)){
-                cout << strupr_linux(token) << "\n";
-            } else {
-                    cout << "ID." << token << "\n";
-            }
-        }
-
-        // Numeros inteiros
-        else if (isdigit(c)){
-            token = c;
-            coluna++;
-            bool tem_ponto = false;
-            bool erro_zero_esquerda = false;
-            int coluna_erro = coluna -1; // posição inicial do número
-
-            while (arquivo.get(c)){
-                if(isdigit(c)){
-                    // Verifica zero à esquerda apenas antes do primeiro dígito não-zero
-                    if (!tem_ponto && token.size() == 1 && token[0] == '0' && c != '0') {
-                        erro_zero_esquerda = true;
-                    }
-                    token += c;
-                    coluna++;
-                } else if (c == '.' && !tem_ponto) {
-                    tem_ponto = true;
-                    token += c;
-                    coluna++;
-                } else {
-                    arquivo.unget();
-                    break;
-                }
-            }
-            // verificando depois da leitura dos dígitos
-            if (tem_ponto) {
-                size_t pos_ponto = token.find('.');
-                string parte_inteira = token.substr(0, pos_ponto);
-                string parte_frac = token.substr(pos_ponto + 1);
-
-                // Erro: parte inteira com zero à esquerda
-                if (parte_inteira.size() > 1 && parte_inteira[0] == '0') {
-                    cerr << "\033[31mEncontrado ERRO na linha " << linha << ", coluna " << coluna_erro 
-                        << ": zero à esquerda em número float '" << token << "'\033[0m\n";
-                }
-
-                // Erro: parte fracionária faltando
-                if (parte_frac.empty()) {
-                    cerr << "\033[31m Encontrado ERRO na linha " << linha << ", coluna " << (coluna - 1)
-                        << ": parte fracionária faltando após ponto decimal\033[0m\n";
-                }
-            } 
-            else {
-                // Erro: inteiro com zero à esquerda
-                if (token.size() > 1 && token[0] == '0') {
-                    cerr << "\033[31mEncontrado ERRO na linha " << linha << ", coluna " << coluna_erro
-                        << ": zero à esquerda em número inteiro '" << token << "'\033[0m\n";
-                }
-            }
-
-            cout << "NUM." << token << "\n";
-        }
-
-        // Simbolos e operadores
-        else{
-            switch (c){
-                case '(': cout << "LPARENT\n"; break; 
-                case ')': cout << "RPARENT\n"; break; 
-                case '{': cout << "LBRACE\n"; break; 
-                case '}': cout << "RBRACE\n"; break; 
-                case ';': cout << "SEMICOLON\n"; break; 
-                case ',': cout << "COMMA\n"; break;
-                case '%': cout << "MOD\n"; break; // Modulo da divisao
-                case '=':
-                    if (arquivo.get(c) && c == '='){
-                        cout << "EQ\n";  // EQ para "equal"
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere se nao for '='
-                        cout << "ASSIGN\n";
-                    }
-                    break;
-
-                case '+': 
-                    if (arquivo.get(c) && c == '+'){
-                        cout << "INCREMENT\n";  // Incremento
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere se não tiver mais um '+'
-                        cout << "PLUS\n";
-                    }
-                break;
-                case '-': 
-                    if (arquivo.get(c) && c == '-'){
-                        cout << "DECREMENT\n";  // Decremento
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere se não tiver mais um '-'
-                        cout << "MINUS\n";
-                    }
-                    break;
-                case '*': cout << "MULT\n"; break;
-                case '/': cout << "DIV\n"; break;
-                case '<': 
-                    if (arquivo.get(c) && c == '='){
-                        cout << "LEQ\n";  // LEQ = Less Than or Equal
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere lido se não for '='
-                        cout << "LT\n";  // LT = Less Than
-                    }
-                    break;
-                case '>':
-                    if (arquivo.get(c) && c == '='){
-                        cout << "GEQ\n";  // GE = Greater or Equal
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere lido se não for '='
-                        cout << "GT\n";  // GT = Greater Than
-                    }
-                    break;
-                case '|': 
-                    if (arquivo.get(c) && c == '|'){
-                        cout << "OR\n";  
-                    } else {
-                        cerr << "\033[31mEncontrado ERRO na linha " << linha << ", coluna " << coluna
-                            << ": operador '|' incompleto ou inválido\033[0m\n";
-                             if (arquivo) arquivo.unget();
-                    }
-                    break;
-                case '!':
-                    if (arquivo.get(c) && c == '='){
-                        cout << "DIFF\n";  // DIFF  = Different
-                    } else {
-                        if (arquivo) arquivo.unget(); // Devolve o caractere lido se não for '='
-                        cout << "NEG\n";  // NEG = Negacao logica 
-                    }
-                    break;
-                case '&':
-                    if (arquivo.get(c) && c == '&'){
-                        cout << "AND\n";  
-                    } 
-                    else {
-                        cerr << "\033[31mEncontrado ERRO na linha " << linha << ", coluna " << coluna - 1
-                            << ": operador '&' incompleto ou inválido\033[0m\n";
-                        if (arquivo) arquivo.unget();
-                    }
-                    break;
-
-                // Caso não seja simbolo conhecido, reporta erro
-                default:
-                    cerr << "\033[31m"
-                        << "Encontrado ERRO na linha " << linha << ", coluna " << coluna
-                        << ": caractere inválido '" << c << "'"
-                        << "\033[0m"
-                        << "'\n";
-                    break;
-            }
-        }
-    }
-
-    // Indica o fim do arquivo
-    cout << "EOF\n";
-}
-
-// Função principal
-int main(int argc, char* argv[]){
-    // Verifica se o nome do arquivo foi fornecido
-    if(argc < 2){
-        cerr << "Uso: " << argv[0] << " <arquivo fonte>\n";
-        return 1;
-    }
-
-    // Abre o arquivo
-    ifstream arquivo(argv[1]);
-    if (!arquivo.is_open()){
-        perror("Erro ao abrir o arquivo");
-        return 1;
-    }
-
-    // Chama o analisador lexico
-    analisar(arquivo);
-
-    // Fecha o arquivo
-    arquivo.close();
-
-    return 0;
-}
+// Compiladores 2025.1 - Analisador Lexico
+
+// No linux:
+// Compilar com: g++ -std=c++17 -o analisador analisador.cpp
+// Executar com: ./analisador arquivo.txt
+//           ou: ./analisador --format=bin arquivo.txt > tokens.bin
+//           ou: ./analisador --format=jsonl arquivo.txt
+//           ou: ./analisador --threads=4 arquivo_grande.txt
+//           ou: ./analisador a.txt b.txt @lista_de_arquivos.txt
+//           ou: ./analisador --stats --trace arquivo.txt > /dev/null
+//           ou: ./analisador --encadeado arquivo_grande.txt
+//           ou: ./analisador --cache=.cache_tokens arquivo.txt
+//           ou: ./analisador --sintaxe arquivo.txt
+//           ou: ./analisador --executar arquivo.txt
+//           ou: ./analisador --nativo=programa arquivo.txt && ./programa
+//           ou: gerador | ./analisador -
+//           ou: ./analisador --serve=/tmp/analisador.sock &
+//               ./analisador --cliente=/tmp/analisador.sock arquivo.txt
+
+// Para o --nativo, o runtime fica ao lado do analisador (senao eh compilado
+// de runtime_nativo.cpp no primeiro uso):
+//               g++ -std=c++17 -O2 -c runtime_nativo.cpp
+
+// No windows:
+// Compilar com: g++ -std=c++17 analisador.cpp
+// Executar com: .\a arquivo.txt
+
+// Bibliotecas utilizadas
+#include <iostream>     // entrada e saida (cout, cerr)
+#include <fstream>      // manipulacao de arquivos (ifstream)
+#include <string>       // manipulacao de strings
+#include <cstdio>       // perror
+#include <cstdlib>      // atoi
+#include <cstring>      // strerror
+#include <cerrno>       // errno
+#include <vector>       // lista de arquivos do lote
+#include <deque>        // arquivos do lote em andamento
+#include <algorithm>    // max
+#include <filesystem>   // caminho absoluto enviado ao servidor
+
+#include "entrada.h"    // arquivo fonte mapeado em memoria
+#include "lexer.h"      // analisador lexico (Token, Lexer)
+#include "analise.h"    // nucleo da analise: memoria, fluxo e encadeada
+#include "paralelo.h"   // analise de arquivos grandes em pedacos paralelos
+#include "encadeado.h"  // Lexer em outra thread, ligado por uma fila SPSC
+#include "fluxo.h"      // analise de stdin e pipes com memoria limitada
+#include "saida.h"      // formatos de saida (texto, jsonl, bin)
+#include "perfil.h"     // tempos e contadores de hardware (--trace)
+#include "cache.h"      // cache de tokens por hash do conteudo (--cache)
+#include "servidor.h"   // processo residente num socket Unix (--serve, --cliente)
+#include "sintatico.h"  // analisador sintatico e arvore (--sintaxe)
+#include "bytecode.h"   // traducao para bytecode (--bytecode)
+#include "vm.h"         // maquina virtual (--executar)
+#include "nativo.h"     // assembly x86-64 (--assembly, --nativo)
+
+#ifdef _WIN32
+#include <io.h>         // _setmode
+#include <fcntl.h>      // _O_BINARY
+#endif
+
+using namespace std;    // evita usar std:: a cada chamada
+
+// O que fazer com o programa inteiro, alem de listar os tokens
+enum modos_programa { modo_tokens, modo_sintaxe, modo_bytecode, modo_executar, modo_assembly, modo_nativo };
+
+// Leva o programa [inicio, fim) ate a fase do modo: a arvore (--sintaxe), a
+// listagem do bytecode (--bytecode), o assembly (--assembly; o --nativo usa
+// o mesmo) ou a execucao (--executar) saem em canal_saida e os erros em
+// canal_erros. So um programa sem erros lexicos, sintaticos e semanticos eh
+// traduzido e executado.
+// Os tokens vem de 'lexer' (o Lexer ou TokensEncadeados, ambos sobre
+// [inicio, fim)). Retorna o codigo de saida: o valor do return do programa
+// (0 se ele chegou ao fim) ou 1 se houve erros
+template<class FonteTokens>
+int analisar_programa(FonteTokens& lexer, const char* inicio, const char* fim, modos_programa modo,
+                      CanalSaida& canal_saida, CanalSaida& canal_erros){
+    TabelaSimbolos simbolos;
+    Arvore arvore;
+    arvore.reservar((size_t)(fim - inicio));
+    Parser parser(lexer, arvore, simbolos);
+    parser.programa();
+    IndiceLinhas linhas(inicio, fim);
+
+    if (modo == modo_sintaxe){
+        escrever_arvore(canal_saida, arvore, simbolos);
+        canal_saida.descarregar();
+        escrever_erros(canal_erros, lexer.diagnosticos, parser.erros, linhas);
+        return 0;
+    }
+    if (escrever_erros(canal_erros, lexer.diagnosticos, parser.erros, linhas) > 0) return 1;
+
+    ProgramaBytecode programa;
+    CompiladorBytecode compilador(arvore, simbolos);
+    if (!compilador.compilar(programa)){
+        for (const ErroSemantico& erro : compilador.erros)
+            formatar_erro_semantico(canal_erros, erro, linhas.posicao(erro.offset), canal_erros.interativo);
+        return 1;
+    }
+    if (modo == modo_bytecode){
+        escrever_bytecode(canal_saida, programa);
+        return 0;
+    }
+    if (modo == modo_assembly || modo == modo_nativo){
+        escrever_assembly(canal_saida, programa, linhas);
+        return 0;
+    }
+
+    // print escreve em canal_saida e readln le a entrada padrao
+    ResultadoExecucao resultado = executar(programa, canal_saida, cin);
+    canal_saida.descarregar();
+    if (!resultado.ok){
+        formatar_erro_execucao(canal_erros, resultado, linhas.posicao(resultado.offset), canal_erros.interativo);
+        return 1;
+    }
+    return (int)(resultado.codigo_saida & 0xff);
+}
+
+int analisar_programa(const char* inicio, const char* fim, modos_programa modo, bool encadeado,
+                      CanalSaida& canal_saida, CanalSaida& canal_erros){
+    if (encadeado){
+        TokensEncadeados tokens(inicio, fim);
+        return analisar_programa(tokens, inicio, fim, modo, canal_saida, canal_erros);
+    }
+    Lexer lexer(inicio, fim);
+    return analisar_programa(lexer, inicio, fim, modo, canal_saida, canal_erros);
+}
+
+// Resultado de um arquivo do modo em lote: a saida fica em canais em memoria
+// ate chegar a vez do arquivo na ordem dos argumentos
+struct ResultadoArquivo {
+    CanalSaida tokens;
+    CanalSaida erros;
+    size_t diagnosticos = 0;
+    bool falhou = false;    // o arquivo (ou a sua saida) nao pode ser aberto
+    EstatisticasLexicas estatisticas;
+};
+
+// Opcoes de saida comuns a todos os arquivos do lote
+struct OpcoesLote {
+    formatos_saida formato;
+    bool posicoes;
+    bool por_arquivo;       // grava cada saida em <arquivo>.tokens|.jsonl|.bin
+    bool estatisticas;      // conta tokens e identificadores (--stats)
+};
+
+// analisa um arquivo inteiro do lote (executado nas threads do conjunto)
+void analisar_arquivo(const string& caminho, const OpcoesLote& opcoes, ResultadoArquivo& resultado){
+    {
+        unique_ptr<Saida> formatada = criar_saida(opcoes.formato, resultado.tokens, resultado.erros, opcoes.posicoes);
+        formatada->origem = caminho;
+        SaidaEstatisticas contagem(*formatada, resultado.estatisticas);
+        Saida& saida = opcoes.estatisticas ? (Saida&)contagem : *formatada;
+        TabelaSimbolos* simbolos = opcoes.estatisticas ? &resultado.estatisticas.simbolos : nullptr;
+
+        if (!analisar_caminho(caminho, saida, simbolos)){
+            resultado.erros.escrever("Erro ao abrir o arquivo " + caminho + ": " + strerror(errno) + "\n");
+            resultado.falhou = true;
+            return;
+        }
+        resultado.diagnosticos = formatada->total_diagnosticos;
+    }
+
+    if (opcoes.por_arquivo){
+        static const char* extensoes[] = {".tokens", ".jsonl", ".bin"};
+        string destino = caminho + extensoes[opcoes.formato];
+        ofstream saida(destino, ios::binary);
+        saida.write(resultado.tokens.buffer.data(), resultado.tokens.buffer.size());
+        if (!saida){
+            resultado.erros.escrever("Erro ao gravar o arquivo " + destino + "\n");
+            resultado.falhou = true;
+        }
+        string().swap(resultado.tokens.buffer);     // libera a memoria ja gravada
+    }
+}
+
+// Analisa varios arquivos em um conjunto de threads com roubo de tarefas.
+// A saida (ou, com por_arquivo, so os erros) sai na ordem dos argumentos,
+// com no maximo 4 arquivos por thread guardados em memoria.
+// Retorna o codigo de saida: 0 sem erros, 1 se algum arquivo nao abriu,
+// 2 se houve erros lexicos
+int analisar_lote(const vector<string>& caminhos, const OpcoesLote& opcoes, unsigned threads,
+                  CanalSaida& canal_tokens, CanalSaida& canal_erros){
+    struct EmAndamento {
+        unique_ptr<ResultadoArquivo> resultado;
+        future<void> pronto;
+    };
+    ConjuntoThreads conjunto(threads);
+    deque<EmAndamento> fila;
+    const size_t max_em_andamento = 4 * (size_t)conjunto.tamanho();
+
+    size_t proximo = 0, total_diagnosticos = 0, arquivos_com_erros = 0;
+    bool falhou = false;
+    EstatisticasLexicas estatisticas;
+    while (true){
+        while (proximo < caminhos.size() && (opcoes.por_arquivo || fila.size() < max_em_andamento)){
+            auto resultado = make_unique<ResultadoArquivo>();
+            ResultadoArquivo* alvo = resultado.get();
+            const string* caminho = &caminhos[proximo++];
+            future<void> pronto = conjunto.enviar([caminho, &opcoes, alvo]{ analisar_arquivo(*caminho, opcoes, *alvo); });
+            fila.push_back({move(resultado), move(pronto)});
+        }
+        if (fila.empty()) break;
+
+        EmAndamento atual = move(fila.front());
+        fila.pop_front();
+        atual.pronto.get();
+        ResultadoArquivo& resultado = *atual.resultado;
+
+        canal_tokens.escrever(resultado.tokens.buffer);
+        if (canal_erros.interativo && canal_tokens.interativo) canal_tokens.descarregar();
+        else canal_tokens.verificar();
+        canal_erros.escrever(resultado.erros.buffer);
+        canal_erros.verificar();
+
+        falhou |= resultado.falhou;
+        total_diagnosticos += resultado.diagnosticos;
+        if (resultado.diagnosticos > 0) arquivos_com_erros++;
+        if (opcoes.estatisticas) estatisticas.acumular(resultado.estatisticas);
+    }
+
+    // resumo dos erros de todos os arquivos
+    canal_tokens.descarregar();
+    if (opcoes.estatisticas) escrever_estatisticas(canal_erros, estatisticas);
+    canal_erros.escrever_numero((int64_t)caminhos.size());
+    canal_erros.escrever(" arquivo(s) analisado(s), ");
+    canal_erros.escrever_numero((int64_t)total_diagnosticos);
+    canal_erros.escrever(" erro(s) léxico(s) em ");
+    canal_erros.escrever_numero((int64_t)arquivos_com_erros);
+    canal_erros.escrever(" arquivo(s)\n");
+
+    if (falhou) return 1;
+    return total_diagnosticos > 0 ? 2 : 0;
+}
+
+// atende um pedido do --serve: a mesma analise de um arquivo (ou do texto
+// enviado) que o analisador faria sem outras opcoes, com a saida nos canais em
+// memoria da arena da thread
+int atender_pedido(const Pedido& pedido, ArenaTrabalhador& arena){
+    arena.erros.interativo = pedido.cor;
+    unique_ptr<Saida> saida = criar_saida(pedido.formato, arena.tokens, arena.erros, pedido.posicoes);
+    if (pedido.tipo == pedido_texto){
+        analisar(pedido.conteudo.data(), pedido.conteudo.data() + pedido.conteudo.size(), *saida);
+        return 0;
+    }
+
+    // o cliente manda o caminho absoluto; um "-" aqui eh um arquivo com esse
+    // nome, nunca a entrada padrao do servidor
+    string caminho = pedido.conteudo == "-" ? "./-" : string(pedido.conteudo);
+    if (!analisar_caminho(caminho, *saida)){
+        arena.erros.escrever(string("Erro ao abrir o arquivo: ") + strerror(errno) + "\n");
+        return 1;
+    }
+    return 0;
+}
+
+// Função principal
+int main(int argc, char* argv[]){
+    formatos_saida formato = formato_texto;
+    bool posicoes = false;      // offset, linha e coluna de cada token no formato binario
+    bool assincrona = false;    // grava os tokens em uma thread separada
+    bool por_arquivo = false;   // no lote, grava a saida de cada arquivo ao lado dele
+    bool com_estatisticas = false;  // resumo de tokens e identificadores em stderr
+    bool com_perfil = false;    // tempos de entrada, classificacao e saida em stderr
+    bool encadeado = false;     // Lexer numa thread e saida (ou Parser) em outra
+    string diretorio_cache;     // com --cache, tokens de arquivos ja vistos vem do disco
+    uint64_t limite_cache = 256ull << 20;
+    string socket_servidor;     // --serve: atende pedidos neste socket
+    string socket_cliente;      // --cliente (ou ANALISADOR_SOCKET): pede ao servidor
+    string executavel_nativo;   // --nativo: executavel gerado a partir do assembly
+    if (const char* ambiente = getenv("ANALISADOR_SOCKET")) socket_cliente = ambiente;
+    modos_programa modo = modo_tokens;
+    unsigned threads = 0;       // 0 = sequencial para um arquivo, uma por nucleo no lote
+    bool lote = false;
+    vector<string> caminhos;
+
+    // Opcoes e arquivos (ou @lista com um arquivo por linha)
+    for (int i = 1; i < argc; i++){
+        string argumento = argv[i];
+        if (argumento == "--format=text"){
+            formato = formato_texto;
+        } else if (argumento == "--format=jsonl"){
+            formato = formato_jsonl;
+        } else if (argumento == "--format=bin"){
+            formato = formato_bin;
+        } else if (argumento == "--saida-assincrona"){
+            assincrona = true;
+        } else if (argumento == "--posicoes"){
+            posicoes = true;
+        } else if (argumento == "--saida-por-arquivo"){
+            por_arquivo = true;
+        } else if (argumento == "--stats"){
+            com_estatisticas = true;
+        } else if (argumento == "--trace"){
+            com_perfil = true;
+            com_estatisticas = true;
+        } else if (argumento.rfind("--cache=", 0) == 0){
+            diretorio_cache = argumento.substr(8);
+        } else if (argumento.rfind("--cache-max=", 0) == 0){
+            limite_cache = strtoull(argumento.c_str() + 12, nullptr, 10) << 20;   // em MiB
+        } else if (argumento.rfind("--serve=", 0) == 0){
+            socket_servidor = argumento.substr(8);
+        } else if (argumento.rfind("--cliente=", 0) == 0){
+            socket_cliente = argumento.substr(10);
+        } else if (argumento == "--encadeado"){
+            encadeado = true;
+        } else if (argumento == "--sintaxe"){
+            modo = modo_sintaxe;
+        } else if (argumento == "--bytecode"){
+            modo = modo_bytecode;
+        } else if (argumento == "--executar"){
+            modo = modo_executar;
+        } else if (argumento == "--assembly"){
+            modo = modo_assembly;
+        } else if (argumento.rfind("--nativo=", 0) == 0){
+            modo = modo_nativo;
+            executavel_nativo = argumento.substr(9);
+        } else if (argumento.rfind("--threads=", 0) == 0){
+            threads = (unsigned)atoi(argumento.c_str() + 10);
+            if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        } else if (argumento.rfind("--", 0) == 0){
+            cerr << "Opcao desconhecida: " << argumento << "\n";
+            return 1;
+        } else if (argumento[0] == '@'){
+            if (!ler_lista_arquivos(argv[i] + 1, caminhos)){
+                perror(("Erro ao abrir a lista " + argumento.substr(1)).c_str());
+                return 1;
+            }
+            lote = true;
+        } else {
+            caminhos.push_back(argumento);
+        }
+    }
+    lote = lote || por_arquivo || caminhos.size() > 1;
+
+    // Servidor: fica no ar ate SIGINT/SIGTERM, com uma thread por nucleo
+    if (!socket_servidor.empty()){
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        ServidorLexico servidor(socket_servidor, threads);
+        return servidor.servir(atender_pedido);
+    }
+
+    // Verifica se o nome do arquivo foi fornecido
+    if (caminhos.empty() && !lote){
+        cerr << "Uso: " << argv[0] << " [--format=text|jsonl|bin] [--posicoes] [--saida-assincrona] [--threads=N] [--encadeado]"
+                " [--cache=diretorio] [--cache-max=MiB]"
+                " [--serve=socket] [--cliente=socket]"
+                " [--saida-por-arquivo] [--stats] [--trace] [--sintaxe|--bytecode|--executar|--assembly|--nativo=executavel]"
+                " <arquivo fonte | ->... [@lista]\n"
+                "--nativo liga o programa a runtime_nativo.o, no diretorio do analisador"
+                " (g++ -std=c++17 -O2 -c runtime_nativo.cpp)\n";
+        return 1;
+    }
+
+#ifdef _WIN32
+    // a saida binaria nao pode ter "\n" convertido para "\r\n"
+    if (formato == formato_bin) _setmode(_fileno(stdout), _O_BINARY);
+    // nem a entrada ter "\r\n" convertido para "\n": os offsets sao os do
+    // arquivo, como no mapeamento
+    _setmode(_fileno(stdin), _O_BINARY);
+#endif
+
+    // Cliente: um arquivo so, com as opcoes que o servidor conhece, vai para
+    // o servidor; sem servidor no ar a analise segue aqui mesmo. Com stdout e
+    // stderr no terminal a analise eh local, para os erros sairem intercalados
+    // com os tokens
+    if (!socket_cliente.empty() && !lote && modo == modo_tokens && !com_estatisticas && diretorio_cache.empty() &&
+        !(eh_terminal(1) && eh_terminal(2))){
+        uint8_t opcoes = (posicoes ? pedido_posicoes : 0) | (eh_terminal(2) ? pedido_cor : 0);
+        int status = 0;
+        bool atendido;
+        if (caminhos[0] == "-"){
+            string texto = ler_fluxo(cin);
+            atendido = pedir_ao_servidor(socket_cliente, pedido_texto, formato, opcoes, texto, status);
+            if (!atendido){
+                // a entrada ja foi consumida: analisa o texto lido
+                CanalSaida canal_tokens(1), canal_erros(2);
+                unique_ptr<Saida> saida = criar_saida(formato, canal_tokens, canal_erros, posicoes);
+                analisar(texto.data(), texto.data() + texto.size(), *saida);
+                return 0;
+            }
+        } else {
+            error_code erro;
+            string absoluto = filesystem::absolute(caminhos[0], erro).string();
+            atendido = pedir_ao_servidor(socket_cliente, pedido_arquivo, formato, opcoes,
+                                         erro ? caminhos[0] : absoluto, status);
+        }
+        if (atendido) return status;
+    }
+
+    // Tokens em stdout e erros em stderr, ambos com buffer
+    CanalSaida canal_tokens(1, assincrona);
+    CanalSaida canal_erros(2);
+
+    // Varios arquivos: um conjunto de threads, um arquivo por tarefa
+    if (lote){
+        if (modo != modo_tokens){
+            cerr << "--sintaxe, --bytecode, --executar, --assembly e --nativo analisam um arquivo por vez\n";
+            return 1;
+        }
+        if (com_perfil) cerr << "--trace mede apenas a analise de um arquivo; no lote so vale --stats\n";
+        if (threads == 0) threads = max(1u, thread::hardware_concurrency());
+        return analisar_lote(caminhos, {formato, posicoes, por_arquivo, com_estatisticas}, threads, canal_tokens, canal_erros);
+    }
+
+    EntradaAnalise entrada;
+    double inicio_entrada = relogio();
+    if (!abrir_entrada(caminhos[0], entrada)){
+        perror("Erro ao abrir o arquivo");
+        return 1;
+    }
+
+    // --sintaxe, --bytecode, --executar, --assembly e --nativo: o programa
+    // inteiro fica em memoria (a arvore aponta para ele)
+    if (modo != modo_tokens){
+        string texto;
+        if (entrada.fluxo) texto = ler_fluxo(*entrada.fluxo);
+        const char* inicio = entrada.fluxo ? texto.data() : entrada.inicio();
+        const char* fim = entrada.fluxo ? texto.data() + texto.size() : entrada.fim();
+        if (modo != modo_nativo) return analisar_programa(inicio, fim, modo, encadeado, canal_tokens, canal_erros);
+
+        // --nativo: o assembly, em memoria, vai para executavel.s, que o
+        // compilador C++ monta e liga com o runtime (runtime_nativo.o)
+        CanalSaida assembly;
+        int status = analisar_programa(inicio, fim, modo, encadeado, assembly, canal_erros);
+        if (status != 0) return status;
+#ifdef _WIN32
+        cerr << "--nativo disponivel apenas no linux (use --assembly)\n";
+        return 1;
+#else
+        string erro_runtime;
+        string runtime = preparar_runtime_nativo(erro_runtime);
+        if (runtime.empty()){
+            canal_erros.descarregar();
+            cerr << erro_runtime << "\n";
+            return 1;
+        }
+        if (!montar_executavel(assembly.buffer, executavel_nativo, runtime)){
+            cerr << "Erro ao gerar o executavel " << executavel_nativo << "\n";
+            return 1;
+        }
+        return 0;
+#endif
+    }
+    unique_ptr<Saida> formatada = criar_saida(formato, canal_tokens, canal_erros, posicoes);
+
+    // com --stats os tokens passam pela contagem antes do formato pedido
+    EstatisticasLexicas estatisticas;
+    SaidaEstatisticas contagem(*formatada, estatisticas);
+    Saida& saida = com_estatisticas ? (Saida&)contagem : *formatada;
+    TabelaSimbolos* simbolos = com_estatisticas ? &estatisticas.simbolos : nullptr;
+
+    // com --trace a analise eh sequencial, em lotes medidos pelo Perfilador
+    unique_ptr<Perfilador> perfil;
+    if (com_perfil) perfil = make_unique<Perfilador>();
+
+    if (entrada.fluxo){
+        // "-" e entradas nao buscaveis (pipe, fifo, ...) sao lidas em blocos
+        analisar(*entrada.fluxo, saida, simbolos, perfil.get());
+    } else {
+        // Arquivos comuns sao analisados direto da memoria; com --cache um
+        // conteudo ja visto eh reproduzido do cache e um novo eh gravado nele
+        // enquanto passa para a saida
+        const char* inicio = entrada.inicio();
+        const char* fim = entrada.fim();
+        unique_ptr<CacheTokens> cache;
+        unique_ptr<SaidaGravacaoCache> gravacao;
+        bool do_cache = false;
+        if (!diretorio_cache.empty()){
+            cache = make_unique<CacheTokens>(diretorio_cache, limite_cache);
+            ChaveCache chave = chave_cache(inicio, entrada.mapa.tamanho);
+            do_cache = cache->reproduzir(chave, inicio, saida);
+            if (!do_cache) gravacao = cache->gravar(chave, saida);
+        }
+        Saida& destino = gravacao ? (Saida&)*gravacao : saida;
+
+        if (do_cache){
+            // nada a analisar
+        } else if (perfil){
+            tocar_paginas(inicio, entrada.mapa.tamanho);
+            perfil->tempo_entrada += relogio() - inicio_entrada;
+            analisar(inicio, fim, destino, simbolos, perfil.get());
+        } else if (threads > 1){
+            ConjuntoThreads conjunto(threads);
+            analisar_paralelo(inicio, fim, destino, conjunto);
+        } else if (encadeado){
+            analisar_encadeado(inicio, fim, destino);
+        } else {
+            analisar(inicio, fim, destino, simbolos);
+        }
+        if (gravacao && gravacao->concluir() > 0) cache->limitar();
+    }
+
+    if (com_estatisticas){
+        double inicio_gravacao = relogio();
+        canal_tokens.descarregar();
+        if (perfil) perfil->tempo_saida += relogio() - inicio_gravacao;
+        escrever_estatisticas(canal_erros, estatisticas);
+        if (perfil) escrever_perfil(canal_erros, *perfil);
+    }
+    return 0;
+}
@@ -0,0 +1,124 @@
+// Compiladores 2025.1 - Analise lexica de uma entrada inteira (biblioteca)
+//
+// O nucleo comum aos dois executaveis, analisador.cpp e lexico.cpp: leva a
+// entrada pelo Lexer (lexer.h) ate uma Saida (saida.h), com os erros
+// encontrados antes de cada token entregues antes dele. As variantes
+// (memoria, fluxo em blocos, Lexer em outra thread) produzem a mesma
+// sequencia de tokens e erros; a de paralelo.h tambem. O benchmark
+// --diferencial confere isso contra o analisador original de referencia.h,
+// que nao compartilha tabelas nem conversoes com o Lexer.
+//
+// Uso:
+//     CanalSaida tokens(1), erros(2);
+//     SaidaTexto saida(tokens, erros);
+//     if (!analisar_caminho("arquivo.txt", saida)) perror("arquivo.txt");
+
+#ifndef ANALISE_H
+#define ANALISE_H
+
+#include <fstream>
+#include <iostream>         // cin
+#include <string>
+
+#include "entrada.h"        // ArquivoMapeado
+#include "lexer.h"
+#include "linhas.h"
+#include "encadeado.h"      // TokensEncadeados
+#include "fluxo.h"          // analise em blocos
+#include "perfil.h"
+#include "saida.h"
+
+// entrega os tokens de 'fonte' (Lexer, TokensEncadeados, ...), cada um
+// depois dos erros encontrados antes dele, ate o EOF
+template<class FonteTokens>
+void entregar_tokens(FonteTokens& fonte, Saida& saida){
+    while (true){
+        Token token = fonte.proximo();
+
+        for (const Diagnostico& erro : fonte.diagnosticos)
+            saida.diagnostico(erro);
+        fonte.diagnosticos.clear();
+
+        saida.token(token);
+
+        // Indica o fim do arquivo
+        if (token.tipo == tk_eof) break;
+    }
+}
+
+// realiza a analise lexica sobre um bloco contiguo de memoria [inicio, fim)
+// entregando cada token do Lexer (e os erros encontrados antes dele) a saida;
+// com 'simbolos' os IDs saem com o id do nome na tabela e com 'perfil' os
+// tokens passam em lotes pelo Perfilador (--trace)
+inline void analisar(const char* inicio, const char* fim, Saida& saida, TabelaSimbolos* simbolos = nullptr,
+                     Perfilador* perfil = nullptr){
+    Lexer lexer(inicio, fim);
+    lexer.simbolos = simbolos;
+
+    // linhas e colunas so sao calculadas se a saida pedir (erros, jsonl)
+    IndiceLinhas linhas(inicio, fim);
+    saida.usar_linhas(&linhas);
+
+    if (perfil) perfil->analisar(lexer, saida);
+    else entregar_tokens(lexer, saida);
+    saida.usar_linhas(nullptr);
+}
+
+// realiza a analise lexica de uma entrada nao buscavel (stdin, pipe, fifo, ...)
+// lendo em blocos para um buffer de tamanho fixo
+inline void analisar(std::istream& entrada, Saida& saida, TabelaSimbolos* simbolos = nullptr,
+                     Perfilador* perfil = nullptr){
+    analisar_fluxo(entrada, saida, simbolos, tamanho_bloco_fluxo, perfil);
+}
+
+// como analisar(), mas com o Lexer numa thread separada que entrega os tokens
+// em lotes (--encadeado); esta thread so formata a saida. Sem tabela de
+// simbolos no Lexer: com --stats os IDs sao internados pela SaidaEstatisticas,
+// nesta thread
+inline void analisar_encadeado(const char* inicio, const char* fim, Saida& saida){
+    TokensEncadeados tokens(inicio, fim);
+
+    IndiceLinhas linhas(inicio, fim);
+    saida.usar_linhas(&linhas);
+    entregar_tokens(tokens, saida);
+    saida.usar_linhas(nullptr);
+}
+
+// Um arquivo aberto para a analise: mapeado em memoria quando possivel (o
+// texto inteiro em [inicio(), fim())), senao lido como fluxo
+struct EntradaAnalise {
+    ArquivoMapeado mapa;
+    std::ifstream arquivo;
+    std::istream* fluxo = nullptr;      // pipes, fifos e "-"; nullptr se mapeado
+
+    const char* inicio() const { return mapa.dados; }
+    const char* fim() const { return mapa.dados + mapa.tamanho; }
+};
+
+// Abre 'caminho' ("-" eh a entrada padrao). O fluxo eh binario, como o
+// mapeamento, para que os dois caminhos vejam os mesmos bytes e offsets.
+// Retorna false se o arquivo nao pode ser aberto (o motivo fica em errno)
+inline bool abrir_entrada(const std::string& caminho, EntradaAnalise& entrada){
+    if (caminho == "-"){
+        entrada.fluxo = &std::cin;
+        return true;
+    }
+    if (mapear_arquivo(caminho.c_str(), entrada.mapa)) return true;
+    entrada.arquivo.open(caminho, std::ios::binary);
+    if (!entrada.arquivo.is_open()) return false;
+    entrada.fluxo = &entrada.arquivo;
+    return true;
+}
+
+// Analisa o arquivo 'caminho' inteiro ("-" eh a entrada padrao): da memoria
+// quando mapeado, senao em blocos. Retorna false, sem entregar nada a saida,
+// se o arquivo nao pode ser aberto (o motivo fica em errno)
+inline bool analisar_caminho(const std::string& caminho, Saida& saida, TabelaSimbolos* simbolos = nullptr){
+    EntradaAnalise entrada;
+    if (!abrir_entrada(caminho, entrada)) return false;
+    if (entrada.fluxo) analisar(*entrada.fluxo, saida, simbolos);
+    else analisar(entrada.inicio(), entrada.fim(), saida, simbolos);
+    return true;
+}
+
+#endif
@@ -0,0 +1,170 @@
+// Compiladores 2025.1 - Arvore sintatica
+//
+// A arvore de um programa fica inteira num unico vetor de nos (a arena da
+// Arvore), sem um new por no: os filhos sao ligados por indices de 32 bits
+// (primeiro filho e proximo irmao), cada no tem tamanho fixo, os nos ficam
+// contiguos na ordem em que foram criados e a arvore toda eh liberada de
+// uma vez.
+//
+// Filhos de cada tipo de no, na ordem:
+//   programa, bloco: os comandos
+//   declaracao (operador = tk_int, tk_float, tk_char ou tk_bool): as variaveis
+//   variavel (simbolo): a expressao inicial, se houver
+//   if: condicao, comando do then e, se houver, comando do else
+//   while: condicao e corpo
+//   print: a expressao; readln: o id lido; return: a expressao, se houver
+//   expressao (comando): a expressao
+//   atribuicao: o id e a expressao
+//   binario (operador): os dois operandos
+//   unario (operador tk_minus ou tk_neg): o operando
+//   incremento (operador tk_increment ou tk_decrement; valor.inteiro 1 se
+//   prefixado): o id
+//   id (simbolo), inteiro e real (valor), booleano (valor.inteiro 0 ou 1),
+//   break, vazio (';' sozinho) e erro (expressao que faltou): nenhum
+
+#ifndef AST_H
+#define AST_H
+
+#include <algorithm>    // reverse
+#include <cstdint>
+#include <utility>      // pair
+#include <vector>
+
+#include "lexer.h"      // tipos_token, ValorNumero
+#include "saida.h"      // CanalSaida
+
+// indice de no que nao existe (fim de uma lista de filhos)
+constexpr uint32_t sem_no = 0xffffffff;
+
+enum tipos_no : uint8_t {
+    no_programa, no_bloco, no_declaracao, no_variavel,
+    no_if, no_while, no_break, no_print, no_readln, no_return, no_expressao, no_vazio,
+    no_atribuicao, no_binario, no_unario, no_incremento,
+    no_id, no_inteiro, no_real, no_booleano, no_erro,
+    total_tipos_no
+};
+
+constexpr const char* nomes_nos[total_tipos_no] = {
+    "programa", "bloco", "declaracao", "variavel",
+    "if", "while", "break", "print", "readln", "return", "expressao", "vazio",
+    "atribuicao", "binario", "unario", "incremento",
+    "id", "inteiro", "real", "booleano", "erro"
+};
+
+struct No {
+    tipos_no tipo;
+    tipos_token operador;           // operador ou tipo declarado (tk_eof se nenhum)
+    uint32_t filho = sem_no;        // primeiro filho
+    uint32_t irmao = sem_no;        // proximo filho do mesmo pai
+    uint32_t simbolo = sem_simbolo; // id do nome na tabela de simbolos
+    size_t offset;                  // primeiro byte do token que originou o no
+    ValorNumero valor{};
+};
+
+class Arvore {
+public:
+    std::vector<No> nos;
+    uint32_t raiz = sem_no;
+
+    uint32_t criar(tipos_no tipo, size_t offset, tipos_token operador = tk_eof){
+        nos.push_back({tipo, operador, sem_no, sem_no, sem_simbolo, offset, {}});
+        return (uint32_t)(nos.size() - 1);
+    }
+
+    // reserva o vetor para um fonte de 'bytes_fonte' bytes: codigo tipico
+    // da um no a cada 5 a 8 bytes, e crescer dobrando copiaria a arvore
+    // inteira a cada vez (a parte nao usada da reserva nem chega a ser tocada)
+    void reservar(size_t bytes_fonte){ nos.reserve(bytes_fonte / 5 + 16); }
+
+    No& operator[](uint32_t indice){ return nos[indice]; }
+    const No& operator[](uint32_t indice) const { return nos[indice]; }
+
+    size_t tamanho() const { return nos.size(); }
+    size_t bytes() const { return nos.size() * sizeof(No); }
+
+    // filho de numero 'n' (a partir de 0), ou sem_no
+    uint32_t filho(uint32_t indice, int n) const {
+        uint32_t atual = nos[indice].filho;
+        for (; n > 0 && atual != sem_no; n--) atual = nos[atual].irmao;
+        return atual;
+    }
+
+    void limpar(){
+        nos.clear();
+        raiz = sem_no;
+    }
+};
+
+// Acrescenta filhos ao fim da lista de um no guardando o ultimo, sem
+// percorrer a lista a cada filho
+class ListaFilhos {
+public:
+    ListaFilhos(Arvore& arvore, uint32_t pai) : arvore(arvore), pai(pai) {}
+
+    void acrescentar(uint32_t filho){
+        if (ultimo == sem_no) arvore[pai].filho = filho;
+        else arvore[ultimo].irmao = filho;
+        ultimo = filho;
+    }
+
+private:
+    Arvore& arvore;
+    uint32_t pai;
+    uint32_t ultimo = sem_no;
+};
+
+// Um no por linha, filhos indentados com dois espacos:
+//   atribuicao
+//     id x
+//     binario PLUS ...
+// A pilha eh explicita: cadeias longas como 1 + 1 + ... + 1 viram arvores
+// tao fundas quanto o numero de termos
+inline void escrever_arvore(CanalSaida& canal, const Arvore& arvore, const TabelaSimbolos& simbolos){
+    if (arvore.raiz == sem_no) return;
+    std::vector<std::pair<uint32_t, int>> pilha{{arvore.raiz, 0}};
+    while (!pilha.empty()){
+        auto [indice, nivel] = pilha.back();
+        pilha.pop_back();
+        const No& no = arvore[indice];
+        for (int i = 0; i < nivel; i++) canal.escrever("  ");
+        canal.escrever(nomes_nos[no.tipo]);
+        switch (no.tipo){
+            case no_declaracao:
+            case no_binario:
+            case no_unario:
+            case no_incremento:
+                canal.escrever(" ");
+                canal.escrever(nomes_tokens[no.operador]);
+                if (no.tipo == no_incremento) canal.escrever(no.valor.inteiro ? " prefixo" : " posfixo");
+                break;
+            case no_variavel:
+            case no_id:
+                canal.escrever(" ");
+                canal.escrever(no.simbolo != sem_simbolo ? simbolos.nome(no.simbolo) : "?");
+                break;
+            case no_inteiro:
+                canal.escrever(" ");
+                canal.escrever_numero(no.valor.inteiro);
+                break;
+            case no_real:
+                canal.escrever(" ");
+                canal.escrever_real(no.valor.real);
+                break;
+            case no_booleano:
+                canal.escrever(no.valor.inteiro ? " true" : " false");
+                break;
+            default:
+                break;
+        }
+        canal.escrever("\n");
+        canal.verificar();
+
+        // os filhos entram na pilha invertidos para sairem na ordem
+        size_t primeiro = pilha.size();
+        for (uint32_t filho = no.filho; filho != sem_no; filho = arvore[filho].irmao)
+            pilha.push_back({filho, nivel + 1});
+        std::reverse(pilha.begin() + primeiro, pilha.end());
+    }
+}
+
+#endif
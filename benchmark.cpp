@@ -0,0 +1,796 @@
+// Compiladores 2025.1 - Medicao de desempenho dos analisadores
+
+// No linux:
+// Compilar com: g++ -std=c++17 -O2 -o benchmark benchmark.cpp
+//               (junto com ./analisador e ./lexico, compilados com -O2)
+// Executar com: ./benchmark
+//           ou: ./benchmark --tamanho=64 --mistura=comentarios --repeticoes=5
+//           ou: ./benchmark --gerar=corpus.txt --mistura=erros --tamanho=16
+//           ou: ./benchmark --vm --repeticoes=5
+//           ou: ./benchmark --nativo
+//           ou: ./benchmark --diferencial --historico=historico.jsonl
+//
+// Para cada mistura do gerador (corpus.h) mede, lado a lado:
+//  - referencia: o analisador original de referencia.h (cadeias de if, sem as tabelas)
+//  - lexer: o Lexer de lexer.h dentro deste processo, sem formatar a saida
+//  - parser: o Parser de sintatico.h (Lexer + arvore) dentro deste processo
+//  - lexer_encadeado e parser_encadeado: os mesmos, com o Lexer numa thread
+//    separada entregando lotes de tokens por uma fila SPSC (encadeado.h)
+//  - analisador: o executavel ./analisador (analisar() + saida em texto)
+//  - lexico: o executavel ./lexico (o mesmo nucleo de analise.h, sem opcoes)
+//
+// Cada implementacao roda num processo filho (os executaveis com a saida
+// descartada), para que o pico de memoria (ru_maxrss) de cada uma seja
+// medido separadamente; o das que rodam dentro do benchmark inclui o corpus.
+// Cada medicao eh repetida e vale a mais rapida. Os resultados saem em
+// stdout, um objeto JSON por linha:
+//   {"mistura":"misto","implementacao":"lexico","bytes":...,"tokens":...,
+//    "erros":...,"segundos":...,"mb_s":...,"tokens_s":...,"rss_kb":...,"status":0}
+// "tokens" e "erros" sao contados pelo Lexer (tokens sem o EOF); "status" eh o
+// codigo de saida do processo (0 para o lexer).
+// A linha do parser traz tambem "nos" (nos da arvore), "nos_s" e
+// "bytes_arvore_por_byte" (bytes da arvore por byte do fonte), e seus "erros"
+// incluem os sintaticos.
+//
+// Com --vm mede so a maquina virtual (vm.h): cada kernel C-- abaixo eh
+// traduzido uma vez e executado com os dois despachos, goto computado e switch,
+// para isolar o custo do despacho:
+//   {"kernel":"aritmetica_int","despacho":"goto","instrucoes":...,
+//    "iteracoes":...,"segundos":...,"iteracoes_s":...,"ns_iteracao":...}
+// "instrucoes" eh o tamanho do bytecode; a saida do programa (o print final)
+// precisa ser igual nos dois despachos e, quando o kernel a traz, a esperada.
+//
+// Com --nativo cada kernel tambem vira um executavel x86-64 (nativo.h,
+// ligado a runtime_nativo.cpp, compilado uma vez) medido como processo
+// filho, o que inclui a criacao do processo. A linha dele tem "despacho"
+// "nativo" e "aceleracao", o tempo do goto dividido pelo nativo; a saida tem
+// que ser a mesma da maquina virtual.
+//
+// Com --diferencial cada mistura passa por todos os caminhos da analise
+// lexica: referencia (referencia.h), lexer (analisar), fluxo (em blocos de
+// 4 KiB, para que lexemas e caracteres UTF-8 caiam nas bordas), encadeado e
+// paralelo (pedacos de 64 KiB). Cada um grava a sequencia de tokens e erros
+// entregue a Saida (tipo ou categoria, offset, lexema e bits do valor), que
+// tem que ser identica a da referencia; ./analisador e ./lexico tambem
+// precisam escrever os mesmos stdout e stderr. Uma linha por caminho:
+//   {"commit":"38e820a","mistura":"bordas","implementacao":"fluxo","bytes":...,
+//    "eventos":...,"segundos":...,"mb_s":...,"identico":true}
+// "commit" vem de git rev-parse (ou de --commit=) e, com --historico, as
+// linhas tambem sao acrescentadas ao arquivo, acumulando a vazao de cada
+// caminho commit a commit. A primeira divergencia sai em stderr e o codigo
+// de saida passa a ser 1.
+
+#include <iostream>     // saida dos resultados
+#include <fstream>      // gravacao do corpus
+#include <string>
+#include <vector>
+#include <chrono>       // medicao do tempo
+#include <cstdio>       // snprintf, remove
+#include <cstdlib>      // atoi, strtoull
+#include <cstring>      // strncmp, memcpy
+#include <sstream>      // entrada vazia e saida nativa dos kernels (--vm)
+#include <thread>       // hardware_concurrency
+
+#include "corpus.h"     // gerador de codigo C-- sintetico
+#include "lexer.h"      // analisador lexico (Token, Lexer)
+#include "sintatico.h"  // analisador sintatico (Parser, Arvore)
+#include "encadeado.h"  // Lexer em outra thread (TokensEncadeados)
+#include "referencia.h" // automato de referencia (LexerReferencia)
+#include "analise.h"    // caminhos da analise comparados (--diferencial)
+#include "paralelo.h"   // analisar_paralelo
+#include "vm.h"         // bytecode e maquina virtual (--vm)
+#include "nativo.h"     // assembly x86-64 e montagem (--nativo)
+
+#ifndef _WIN32
+#include <sys/resource.h>   // wait4
+#include <sys/wait.h>       // waitpid
+#include <fcntl.h>          // open
+#include <unistd.h>         // fork, execv, dup2, pipe
+#endif
+
+using namespace std;
+
+struct Opcoes {
+    size_t tamanho = 8 << 20;       // bytes de cada corpus
+    uint64_t semente = 1;
+    int repeticoes = 3;
+    vector<Mistura> misturas{begin(todas_misturas), end(todas_misturas)};
+    string analisador = "./analisador";
+    string lexico = "./lexico";
+    string gerar;                   // grava o corpus neste arquivo e termina
+    bool vm = false;                // mede os kernels da maquina virtual
+    bool nativo = false;            // e tambem o codigo nativo deles
+    string runtime = "./runtime_nativo.cpp";
+    bool diferencial = false;       // compara os caminhos da analise lexica
+    string historico;               // arquivo .jsonl que acumula as medicoes
+    string commit;                  // identificacao da versao medida
+};
+
+struct Medicao {
+    double segundos = 0;
+    long rss_kb = 0;
+    int status = 0;
+};
+
+struct Contagem {
+    size_t tokens = 0;
+    size_t erros = 0;
+};
+
+static double agora(){
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// percorre o corpus inteiro com o Lexer (ou com TokensEncadeados), sem
+// formatar nada
+template<class FonteTokens = Lexer>
+static Contagem contar_tokens(const string& corpus){
+    Contagem contagem;
+    FonteTokens lexer(corpus.data(), corpus.data() + corpus.size());
+    while (true){
+        Token token = lexer.proximo();
+        contagem.erros += lexer.diagnosticos.size();
+        lexer.diagnosticos.clear();
+        if (token.tipo == tk_eof) break;
+        contagem.tokens++;
+    }
+    return contagem;
+}
+
+// roda 'medir' (que devolve uma Medicao) num processo filho e le o pico de
+// memoria dele com wait4: no proprio benchmark o ru_maxrss eh o maior pico
+// desde o inicio, nao o desta medicao. O filho herda o corpus ja em memoria,
+// que entra no pico. O resultado volta por um pipe
+template<class Resultado, class Funcao>
+static Resultado em_processo_filho(Funcao medir){
+    Resultado resultado{};
+#ifdef _WIN32
+    resultado = medir();
+#else
+    int canal[2];
+    if (pipe(canal) < 0){
+        resultado.status = -1;
+        return resultado;
+    }
+    pid_t pid = fork();
+    if (pid == 0){
+        close(canal[0]);
+        Resultado medido = medir();
+        const char* dados = (const char*)&medido;
+        for (size_t escritos = 0; escritos < sizeof medido;){
+            ssize_t n = write(canal[1], dados + escritos, sizeof medido - escritos);
+            if (n <= 0) _exit(1);
+            escritos += (size_t)n;
+        }
+        _exit(0);
+    }
+    close(canal[1]);
+    size_t lidos = 0;
+    while (pid > 0 && lidos < sizeof resultado){
+        ssize_t n = read(canal[0], (char*)&resultado + lidos, sizeof resultado - lidos);
+        if (n <= 0) break;
+        lidos += (size_t)n;
+    }
+    close(canal[0]);
+    int status = 0;
+    rusage uso{};
+    if (pid < 0 || wait4(pid, &status, 0, &uso) < 0 || lidos < sizeof resultado){
+        resultado = Resultado{};
+        resultado.status = -1;
+        return resultado;
+    }
+    resultado.rss_kb = uso.ru_maxrss;
+#endif
+    return resultado;
+}
+
+template<class FonteTokens = Lexer>
+static Medicao medir_lexer(const string& corpus, int repeticoes){
+    return em_processo_filho<Medicao>([&]{
+        Medicao melhor;
+        for (int i = 0; i < repeticoes; i++){
+            double inicio = agora();
+            contar_tokens<FonteTokens>(corpus);
+            double segundos = agora() - inicio;
+            if (i == 0 || segundos < melhor.segundos) melhor.segundos = segundos;
+        }
+        return melhor;
+    });
+}
+
+struct ContagemArvore {
+    size_t nos = 0;
+    size_t bytes = 0;
+    size_t erros = 0;   // lexicos e sintaticos
+};
+
+// monta a arvore do corpus inteiro (a arvore e a tabela de simbolos sao
+// refeitas a cada repeticao, como numa execucao nova)
+struct MedicaoArvore : Medicao {
+    ContagemArvore arvore;
+};
+
+template<class FonteTokens = Lexer>
+static Medicao medir_parser(const string& corpus, int repeticoes, ContagemArvore& contagem){
+    MedicaoArvore medida = em_processo_filho<MedicaoArvore>([&]{
+        MedicaoArvore melhor;
+        for (int i = 0; i < repeticoes; i++){
+            double inicio = agora();
+            FonteTokens lexer(corpus.data(), corpus.data() + corpus.size());
+            TabelaSimbolos simbolos;
+            Arvore arvore;
+            arvore.reservar(corpus.size());
+            Parser parser(lexer, arvore, simbolos);
+            parser.programa();
+            double segundos = agora() - inicio;
+            if (i == 0 || segundos < melhor.segundos) melhor.segundos = segundos;
+            melhor.arvore = {arvore.tamanho(), arvore.bytes(), lexer.diagnosticos.size() + parser.erros.size()};
+        }
+        return melhor;
+    });
+    contagem = medida.arvore;
+    return medida;
+}
+
+#ifndef _WIN32
+// roda 'programa arquivo' (ou so 'programa', sem arquivo) com stdout em
+// 'destino' e stderr em 'destino_erros'
+static Medicao medir_processo(const string& programa, const string& arquivo, int repeticoes,
+                              const string& destino = "/dev/null", const string& destino_erros = "/dev/null"){
+    Medicao melhor;
+    for (int i = 0; i < repeticoes; i++){
+        double inicio = agora();
+        pid_t pid = fork();
+        if (pid == 0){
+            int saida = open(destino.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            int erros = open(destino_erros.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            dup2(saida, 1);
+            dup2(erros, 2);
+            if (arquivo.empty()) execl(programa.c_str(), programa.c_str(), (char*)nullptr);
+            else execl(programa.c_str(), programa.c_str(), arquivo.c_str(), (char*)nullptr);
+            _exit(127);
+        }
+        int status = 0;
+        rusage uso{};
+        if (pid < 0 || wait4(pid, &status, 0, &uso) < 0){
+            melhor.status = -1;
+            return melhor;
+        }
+        double segundos = agora() - inicio;
+        if (i == 0 || segundos < melhor.segundos) melhor.segundos = segundos;
+        melhor.rss_kb = max(melhor.rss_kb, (long)uso.ru_maxrss);
+        melhor.status = WIFEXITED(status) ? WEXITSTATUS(status) : 128 + WTERMSIG(status);
+    }
+    return melhor;
+}
+#endif
+
+static void imprimir(Mistura mistura, const char* implementacao, size_t bytes, const Contagem& contagem,
+                     const Medicao& medicao){
+    double segundos = max(medicao.segundos, 1e-9);
+    char linha[512];
+    snprintf(linha, sizeof linha,
+             "{\"mistura\":\"%s\",\"implementacao\":\"%s\",\"bytes\":%zu,\"tokens\":%zu,\"erros\":%zu,"
+             "\"segundos\":%.6f,\"mb_s\":%.2f,\"tokens_s\":%.0f,\"rss_kb\":%ld,\"status\":%d}",
+             nome_mistura(mistura), implementacao, bytes, contagem.tokens, contagem.erros,
+             medicao.segundos, bytes / segundos / 1e6, contagem.tokens / segundos, medicao.rss_kb, medicao.status);
+    cout << linha << endl;
+}
+
+static void imprimir_parser(Mistura mistura, const char* implementacao, size_t bytes, const Contagem& contagem, const ContagemArvore& arvore,
+                            const Medicao& medicao){
+    double segundos = max(medicao.segundos, 1e-9);
+    char linha[512];
+    snprintf(linha, sizeof linha,
+             "{\"mistura\":\"%s\",\"implementacao\":\"%s\",\"bytes\":%zu,\"tokens\":%zu,\"erros\":%zu,"
+             "\"nos\":%zu,\"segundos\":%.6f,\"mb_s\":%.2f,\"nos_s\":%.0f,\"bytes_arvore_por_byte\":%.3f,"
+             "\"rss_kb\":%ld,\"status\":%d}",
+             nome_mistura(mistura), implementacao, bytes, contagem.tokens, arvore.erros, arvore.nos, medicao.segundos,
+             bytes / segundos / 1e6, arvore.nos / segundos, (double)arvore.bytes / max<size_t>(bytes, 1),
+             medicao.rss_kb, medicao.status);
+    cout << linha << endl;
+}
+
+// Kernels da maquina virtual: cada um eh um laco de 'iteracoes' voltas que
+// exercita uma parte do conjunto de instrucoes
+struct KernelVM {
+    const char* nome;
+    long iteracoes;
+    const char* fonte;
+    const char* saida_esperada = nullptr;   // se dada, conferida em todos os despachos
+};
+
+static const KernelVM kernels_vm[] = {
+    {"laco_vazio", 20000000,
+     "int i = 0;\n"
+     "while (i < 20000000) i++;\n"
+     "print(i);\n"},
+    {"aritmetica_int", 10000000,
+     "int i = 0, s = 0;\n"
+     "while (i < 10000000) {\n"
+     "    s = s * 31 + i % 7 - i / 3;\n"
+     "    i++;\n"
+     "}\n"
+     "print(s);\n"},
+    {"aritmetica_float", 10000000,
+     "int i = 0;\n"
+     "float x = 0.5, s = 0.0;\n"
+     "while (i < 10000000) {\n"
+     "    s = s + x * x - s / 3.0;\n"
+     "    x = x + 0.25;\n"
+     "    i++;\n"
+     "}\n"
+     "print(s);\n"},
+    // collatz: desvios pouco previsiveis
+    {"desvios", 100000,
+     "int n = 1, passos = 0;\n"
+     "while (n <= 100000) {\n"
+     "    int x = n;\n"
+     "    while (x != 1) {\n"
+     "        if (x % 2 == 0) x = x / 2;\n"
+     "        else x = 3 * x + 1;\n"
+     "        passos++;\n"
+     "    }\n"
+     "    n++;\n"
+     "}\n"
+     "print(passos);\n"},
+    // primos por divisao: lacos aninhados, && e break
+    {"lacos_aninhados", 200000,
+     "int n = 2, primos = 0;\n"
+     "while (n < 200000) {\n"
+     "    int d = 2;\n"
+     "    bool primo = true;\n"
+     "    while (d * d <= n && primo) {\n"
+     "        if (n % d == 0) { primo = false; break; }\n"
+     "        d++;\n"
+     "    }\n"
+     "    if (primo) primos++;\n"
+     "    n++;\n"
+     "}\n"
+     "print(primos);\n"},
+    // declaracao sem valor inicial dentro do laco: x volta a 0 a cada volta
+    {"declaracao_no_laco", 1000000,
+     "int i = 0, s = 0;\n"
+     "while (i < 1000000) {\n"
+     "    int x;\n"
+     "    float y;\n"
+     "    s = s + x + y;\n"
+     "    x = i;\n"
+     "    y = 1.5;\n"
+     "    i++;\n"
+     "}\n"
+     "print(s);\n",
+     "0\n"},
+};
+
+// traduz o kernel e mede as duas formas de despacho e, com 'runtime' (o
+// objeto de runtime_nativo.cpp), o executavel nativo
+static bool medir_kernel(const KernelVM& kernel, int repeticoes, const string& runtime){
+    string fonte = kernel.fonte;
+    Lexer lexer(fonte.data(), fonte.data() + fonte.size());
+    TabelaSimbolos simbolos;
+    Arvore arvore;
+    Parser parser(lexer, arvore, simbolos);
+    parser.programa();
+    ProgramaBytecode programa;
+    CompiladorBytecode compilador(arvore, simbolos);
+    if (!lexer.diagnosticos.empty() || !parser.erros.empty() || !compilador.compilar(programa)){
+        cerr << "Kernel " << kernel.nome << " com erros" << endl;
+        return false;
+    }
+
+    string saidas[2];
+    double melhor_vm = 0;
+    for (int com_goto = 1; com_goto >= 0; com_goto--){
+        if (com_goto && !vm_tem_goto) continue;
+        double melhor = 0;
+        for (int i = 0; i < repeticoes; i++){
+            CanalSaida saida;   // em memoria: o kernel so imprime o resultado
+            istringstream entrada;
+            double inicio = agora();
+            ResultadoExecucao resultado = executar(programa, saida, entrada, com_goto);
+            double segundos = agora() - inicio;
+            if (!resultado.ok){
+                cerr << "Kernel " << kernel.nome << ": " << resultado.erro << endl;
+                return false;
+            }
+            if (i == 0 || segundos < melhor) melhor = segundos;
+            saidas[com_goto] = saida.buffer;
+        }
+        char linha[512];
+        snprintf(linha, sizeof linha,
+                 "{\"kernel\":\"%s\",\"despacho\":\"%s\",\"instrucoes\":%zu,\"iteracoes\":%ld,"
+                 "\"segundos\":%.6f,\"iteracoes_s\":%.0f,\"ns_iteracao\":%.2f}",
+                 kernel.nome, com_goto ? "goto" : "switch", programa.codigo.size(), kernel.iteracoes, melhor,
+                 kernel.iteracoes / max(melhor, 1e-9), melhor * 1e9 / kernel.iteracoes);
+        cout << linha << endl;
+        if (com_goto || !vm_tem_goto) melhor_vm = melhor;
+    }
+    if (vm_tem_goto && saidas[0] != saidas[1]){
+        cerr << "Kernel " << kernel.nome << ": saidas diferentes entre goto e switch" << endl;
+        return false;
+    }
+    if (kernel.saida_esperada && saidas[vm_tem_goto ? 1 : 0] != kernel.saida_esperada){
+        cerr << "Kernel " << kernel.nome << ": saida diferente da esperada" << endl;
+        return false;
+    }
+    if (runtime.empty()) return true;
+
+#ifdef _WIN32
+    cerr << "Medicao do codigo nativo disponivel apenas no linux" << endl;
+    return false;
+#else
+    CanalSaida assembly;
+    IndiceLinhas linhas(fonte.data(), fonte.data() + fonte.size());
+    escrever_assembly(assembly, programa, linhas);
+    string executavel = "/tmp/benchmark_" + string(kernel.nome) + "_" + to_string(getpid());
+    string arquivo_saida = executavel + ".out";
+    if (!montar_executavel(assembly.buffer, executavel, runtime)){
+        cerr << "Kernel " << kernel.nome << ": erro ao gerar o executavel nativo" << endl;
+        return false;
+    }
+    Medicao medicao = medir_processo(executavel, "", repeticoes, arquivo_saida);
+    ostringstream saida_nativa;
+    saida_nativa << ifstream(arquivo_saida, ios::binary).rdbuf();
+    for (const string& temporario : {executavel, executavel + ".s", arquivo_saida}) remove(temporario.c_str());
+    if (medicao.status != 0 || saida_nativa.str() != saidas[vm_tem_goto ? 1 : 0]){
+        cerr << "Kernel " << kernel.nome << ": saida do codigo nativo diferente da maquina virtual" << endl;
+        return false;
+    }
+
+    char linha[512];
+    snprintf(linha, sizeof linha,
+             "{\"kernel\":\"%s\",\"despacho\":\"nativo\",\"instrucoes\":%zu,\"iteracoes\":%ld,"
+             "\"segundos\":%.6f,\"iteracoes_s\":%.0f,\"ns_iteracao\":%.2f,\"aceleracao\":%.2f}",
+             kernel.nome, programa.codigo.size(), kernel.iteracoes, medicao.segundos,
+             kernel.iteracoes / max(medicao.segundos, 1e-9), medicao.segundos * 1e9 / kernel.iteracoes,
+             melhor_vm / max(medicao.segundos, 1e-9));
+    cout << linha << endl;
+    return true;
+#endif
+}
+
+// Analise diferencial (--diferencial)
+
+// Um token ou erro, na ordem em que chegou a Saida
+struct Evento {
+    bool erro = false;
+    uint8_t tipo = 0;               // tipos_token ou categorias_erro
+    bool lexema_confere = true;     // o lexema eh o trecho [offset, offset + tamanho) do corpus
+    size_t offset = 0;
+    size_t tamanho = 0;
+    uint64_t valor = 0;             // bits do valor do numero
+
+    bool operator==(const Evento& outro) const {
+        return erro == outro.erro && tipo == outro.tipo && lexema_confere == outro.lexema_confere &&
+               offset == outro.offset && tamanho == outro.tamanho && valor == outro.valor;
+    }
+    bool operator!=(const Evento& outro) const { return !(*this == outro); }
+};
+
+// Saida que so grava os eventos. O lexema eh conferido na hora contra o
+// corpus, porque no fluxo ele aponta para um buffer que sera reaproveitado
+class SaidaGravada : public Saida {
+public:
+    vector<Evento> eventos;
+
+    explicit SaidaGravada(const string& corpus) : corpus(corpus) {}
+
+    void token(const Token& token) override {
+        Evento evento = gravar(token.lexema, token.offset);
+        evento.tipo = (uint8_t)token.tipo;
+        memcpy(&evento.valor, &token.valor, sizeof evento.valor);
+        eventos.push_back(evento);
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        total_diagnosticos++;
+        Evento evento = gravar(erro.lexema, erro.offset);
+        evento.erro = true;
+        evento.tipo = (uint8_t)erro.categoria;
+        eventos.push_back(evento);
+    }
+
+private:
+    const string& corpus;
+
+    Evento gravar(string_view lexema, size_t offset) const {
+        Evento evento;
+        evento.offset = offset;
+        evento.tamanho = lexema.size();
+        evento.lexema_confere = offset <= corpus.size() && corpus.compare(offset, lexema.size(), lexema) == 0;
+        return evento;
+    }
+};
+
+static string descrever(const Evento& evento){
+    char texto[256];
+    snprintf(texto, sizeof texto, "%s %s no offset %zu, %zu bytes%s, valor 0x%016llx",
+             evento.erro ? "erro" : "token",
+             evento.erro ? nomes_erros[evento.tipo] : nomes_tokens[evento.tipo],
+             evento.offset, evento.tamanho, evento.lexema_confere ? "" : " (lexema errado)",
+             (unsigned long long)evento.valor);
+    return texto;
+}
+
+// indice do primeiro evento diferente, ou SIZE_MAX se as sequencias sao iguais
+static size_t primeira_divergencia(const vector<Evento>& esperado, const vector<Evento>& obtido){
+    size_t comum = min(esperado.size(), obtido.size());
+    for (size_t i = 0; i < comum; i++)
+        if (esperado[i] != obtido[i]) return i;
+    return esperado.size() == obtido.size() ? SIZE_MAX : comum;
+}
+
+static ConjuntoThreads& threads_diferencial(){
+    static ConjuntoThreads threads(max(2u, thread::hardware_concurrency()));
+    return threads;
+}
+
+// Os caminhos comparados; o primeiro eh a referencia dos outros
+struct CaminhoLexico {
+    const char* nome;
+    void (*analisar)(const string& corpus, Saida& saida);
+};
+
+static const CaminhoLexico caminhos_lexicos[] = {
+    {"referencia", [](const string& corpus, Saida& saida){
+        LexerReferencia lexer(corpus.data(), corpus.data() + corpus.size());
+        entregar_tokens(lexer, saida);
+    }},
+    {"lexer", [](const string& corpus, Saida& saida){
+        analisar(corpus.data(), corpus.data() + corpus.size(), saida);
+    }},
+    {"fluxo", [](const string& corpus, Saida& saida){
+        istringstream entrada(corpus);
+        analisar_fluxo(entrada, saida, nullptr, 4 << 10);
+    }},
+    {"encadeado", [](const string& corpus, Saida& saida){
+        analisar_encadeado(corpus.data(), corpus.data() + corpus.size(), saida);
+    }},
+    {"paralelo", [](const string& corpus, Saida& saida){
+        analisar_paralelo(corpus.data(), corpus.data() + corpus.size(), saida, threads_diferencial(), 64 << 10);
+    }},
+};
+
+// identifica a versao medida: o commit atual, marcado se ha mudancas locais
+static string commit_atual(){
+    string commit;
+#ifndef _WIN32
+    if (FILE* git = popen("git rev-parse --short HEAD 2>/dev/null", "r")){
+        char linha[64];
+        if (fgets(linha, sizeof linha, git)) commit = linha;
+        pclose(git);
+    }
+    while (!commit.empty() && (commit.back() == '\n' || commit.back() == '\r')) commit.pop_back();
+    if (!commit.empty() && system("git diff --quiet HEAD -- 2>/dev/null") != 0) commit += "-modificado";
+#endif
+    return commit.empty() ? "desconhecido" : commit;
+}
+
+static void imprimir_diferencial(const Opcoes& opcoes, ofstream& historico, Mistura mistura, const char* implementacao,
+                                 size_t bytes, size_t eventos, const Medicao& medicao, bool identico){
+    double segundos = max(medicao.segundos, 1e-9);
+    char linha[512];
+    snprintf(linha, sizeof linha,
+             "{\"commit\":\"%s\",\"mistura\":\"%s\",\"implementacao\":\"%s\",\"bytes\":%zu,\"eventos\":%zu,"
+             "\"segundos\":%.6f,\"mb_s\":%.2f,\"identico\":%s}",
+             opcoes.commit.c_str(), nome_mistura(mistura), implementacao, bytes, eventos, medicao.segundos,
+             bytes / segundos / 1e6, identico ? "true" : "false");
+    cout << linha << endl;
+    if (historico.is_open()) historico << linha << '\n' << flush;
+}
+
+static string ler_arquivo(const string& caminho){
+    ifstream arquivo(caminho, ios::binary);
+    ostringstream conteudo;
+    conteudo << arquivo.rdbuf();
+    return conteudo.str();
+}
+
+// passa o corpus por todos os caminhos e pelos dois executaveis; retorna
+// false se algum deles divergir
+static bool comparar_caminhos(const Opcoes& opcoes, ofstream& historico, Mistura mistura){
+    string corpus = gerar_corpus(mistura, opcoes.tamanho, opcoes.semente);
+    vector<Evento> esperado;
+    bool ok = true;
+
+    for (const CaminhoLexico& caminho : caminhos_lexicos){
+        Medicao melhor;
+        vector<Evento> eventos;
+        for (int i = 0; i < opcoes.repeticoes; i++){
+            SaidaGravada saida(corpus);
+            double inicio = agora();
+            caminho.analisar(corpus, saida);
+            double segundos = agora() - inicio;
+            if (i == 0 || segundos < melhor.segundos) melhor.segundos = segundos;
+            eventos = move(saida.eventos);
+        }
+
+        bool identico = true;
+        if (&caminho == &caminhos_lexicos[0]){
+            esperado = move(eventos);
+            imprimir_diferencial(opcoes, historico, mistura, caminho.nome, corpus.size(), esperado.size(), melhor, true);
+            continue;
+        }
+        size_t i = primeira_divergencia(esperado, eventos);
+        if (i != SIZE_MAX){
+            identico = ok = false;
+            cerr << nome_mistura(mistura) << ": " << caminho.nome << " diverge de " << caminhos_lexicos[0].nome
+                 << " no evento " << i << endl
+                 << "  esperado: " << (i < esperado.size() ? descrever(esperado[i]) : string("fim")) << endl
+                 << "  obtido:   " << (i < eventos.size() ? descrever(eventos[i]) : string("fim")) << endl;
+        }
+        imprimir_diferencial(opcoes, historico, mistura, caminho.nome, corpus.size(), eventos.size(), melhor, identico);
+    }
+
+#ifndef _WIN32
+    // os executaveis: mesma saida em stdout e stderr, e mesmo codigo de saida
+    string prefixo = "/tmp/benchmark_" + string(nome_mistura(mistura)) + "_" + to_string(getpid());
+    string caminho = prefixo + ".txt";
+    {
+        ofstream arquivo(caminho, ios::binary);
+        arquivo.write(corpus.data(), (streamsize)corpus.size());
+        if (!arquivo){
+            cerr << "Erro ao gravar " << caminho << endl;
+            return false;
+        }
+    }
+    size_t bytes = corpus.size();
+    corpus = string();
+
+    Medicao analisador = medir_processo(opcoes.analisador, caminho, opcoes.repeticoes,
+                                        prefixo + ".analisador.out", prefixo + ".analisador.err");
+    Medicao lexico = medir_processo(opcoes.lexico, caminho, opcoes.repeticoes,
+                                    prefixo + ".lexico.out", prefixo + ".lexico.err");
+    bool saida_igual = ler_arquivo(prefixo + ".analisador.out") == ler_arquivo(prefixo + ".lexico.out");
+    bool erros_iguais = ler_arquivo(prefixo + ".analisador.err") == ler_arquivo(prefixo + ".lexico.err");
+    bool identico = saida_igual && erros_iguais && analisador.status == lexico.status && analisador.status != 127;
+    if (!identico){
+        ok = false;
+        cerr << nome_mistura(mistura) << ": " << opcoes.lexico << " diverge de " << opcoes.analisador << " ("
+             << (!saida_igual ? "stdout" : !erros_iguais ? "stderr" : "codigo de saida") << ")" << endl;
+    }
+    imprimir_diferencial(opcoes, historico, mistura, "analisador", bytes, esperado.size(), analisador, identico);
+    imprimir_diferencial(opcoes, historico, mistura, "lexico", bytes, esperado.size(), lexico, identico);
+    for (const char* sufixo : {".txt", ".analisador.out", ".analisador.err", ".lexico.out", ".lexico.err"})
+        remove((prefixo + sufixo).c_str());
+#endif
+    return ok;
+}
+
+static bool ler_opcoes(int argc, char* argv[], Opcoes& opcoes){
+    for (int i = 1; i < argc; i++){
+        string arg = argv[i];
+        if (arg.rfind("--tamanho=", 0) == 0){
+            opcoes.tamanho = (size_t)(atof(arg.c_str() + 10) * (1 << 20));     // em MiB
+        } else if (arg.rfind("--semente=", 0) == 0){
+            opcoes.semente = strtoull(arg.c_str() + 10, nullptr, 10);
+        } else if (arg.rfind("--repeticoes=", 0) == 0){
+            opcoes.repeticoes = max(1, atoi(arg.c_str() + 13));
+        } else if (arg.rfind("--mistura=", 0) == 0){
+            Mistura mistura;
+            if (!ler_mistura(arg.substr(10), mistura)){
+                cerr << "Mistura desconhecida: " << arg.substr(10) << endl;
+                return false;
+            }
+            opcoes.misturas = {mistura};
+        } else if (arg.rfind("--analisador=", 0) == 0){
+            opcoes.analisador = arg.substr(13);
+        } else if (arg.rfind("--lexico=", 0) == 0){
+            opcoes.lexico = arg.substr(9);
+        } else if (arg.rfind("--gerar=", 0) == 0){
+            opcoes.gerar = arg.substr(8);
+        } else if (arg == "--vm"){
+            opcoes.vm = true;
+        } else if (arg == "--nativo"){
+            opcoes.vm = true;
+            opcoes.nativo = true;
+        } else if (arg.rfind("--runtime=", 0) == 0){
+            opcoes.runtime = arg.substr(10);
+        } else if (arg == "--diferencial"){
+            opcoes.diferencial = true;
+        } else if (arg.rfind("--historico=", 0) == 0){
+            opcoes.historico = arg.substr(12);
+        } else if (arg.rfind("--commit=", 0) == 0){
+            opcoes.commit = arg.substr(9);
+        } else {
+            cerr << "Opcao desconhecida: " << arg << endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]){
+    Opcoes opcoes;
+    if (!ler_opcoes(argc, argv, opcoes)){
+        cerr << "Uso: " << argv[0] << " [--tamanho=MiB] [--mistura=identificadores|comentarios|numeros|erros|misto|bordas]"
+                " [--semente=N] [--repeticoes=N] [--analisador=caminho] [--lexico=caminho] [--gerar=arquivo] [--vm]"
+                " [--nativo] [--runtime=runtime_nativo.cpp] [--diferencial] [--historico=arquivo.jsonl]"
+                " [--commit=id]" << endl;
+        return 1;
+    }
+
+    if (!opcoes.gerar.empty()){
+        Mistura mistura = opcoes.misturas.size() == 1 ? opcoes.misturas[0] : Mistura::misto;
+        string corpus = gerar_corpus(mistura, opcoes.tamanho, opcoes.semente);
+        ofstream arquivo(opcoes.gerar, ios::binary);
+        arquivo.write(corpus.data(), (streamsize)corpus.size());
+        if (!arquivo){
+            cerr << "Erro ao gravar " << opcoes.gerar << endl;
+            return 1;
+        }
+        return 0;
+    }
+
+    if (opcoes.vm){
+        // o runtime do codigo nativo eh compilado uma vez para todos os kernels
+        string runtime;
+#ifndef _WIN32
+        if (opcoes.nativo){
+            runtime = "/tmp/benchmark_runtime_" + to_string(getpid()) + ".o";
+            if (!chamar_compilador({"-std=c++17", "-O2", "-c", opcoes.runtime, "-o", runtime})){
+                cerr << "Erro ao compilar " << opcoes.runtime << endl;
+                return 1;
+            }
+        }
+#endif
+        bool ok = true;
+        for (const KernelVM& kernel : kernels_vm) ok = medir_kernel(kernel, opcoes.repeticoes, runtime) && ok;
+        if (!runtime.empty()) remove(runtime.c_str());
+        return ok ? 0 : 1;
+    }
+
+    if (opcoes.diferencial){
+        if (opcoes.commit.empty()) opcoes.commit = commit_atual();
+        ofstream historico;
+        if (!opcoes.historico.empty()){
+            historico.open(opcoes.historico, ios::app);
+            if (!historico.is_open()){
+                cerr << "Nao foi possivel abrir " << opcoes.historico << endl;
+                return 1;
+            }
+        }
+        bool ok = true;
+        for (Mistura mistura : opcoes.misturas) ok = comparar_caminhos(opcoes, historico, mistura) && ok;
+        return ok ? 0 : 1;
+    }
+
+    for (Mistura mistura : opcoes.misturas){
+        string corpus = gerar_corpus(mistura, opcoes.tamanho, opcoes.semente);
+        Contagem contagem = contar_tokens(corpus);
+        imprimir(mistura, "referencia", corpus.size(), contagem,
+                 medir_lexer<LexerReferencia>(corpus, opcoes.repeticoes));
+        imprimir(mistura, "lexer", corpus.size(), contagem, medir_lexer(corpus, opcoes.repeticoes));
+        imprimir(mistura, "lexer_encadeado", corpus.size(), contagem,
+                 medir_lexer<TokensEncadeados>(corpus, opcoes.repeticoes));
+        ContagemArvore arvore;
+        Medicao parser = medir_parser(corpus, opcoes.repeticoes, arvore);
+        imprimir_parser(mistura, "parser", corpus.size(), contagem, arvore, parser);
+        parser = medir_parser<TokensEncadeados>(corpus, opcoes.repeticoes, arvore);
+        imprimir_parser(mistura, "parser_encadeado", corpus.size(), contagem, arvore, parser);
+
+#ifdef _WIN32
+        cerr << "Medicao dos executaveis disponivel apenas no linux" << endl;
+#else
+        char nome[64];
+        snprintf(nome, sizeof nome, "benchmark_%s_%d.txt", nome_mistura(mistura), (int)getpid());
+        string caminho = string("/tmp/") + nome;
+        {
+            ofstream arquivo(caminho, ios::binary);
+            arquivo.write(corpus.data(), (streamsize)corpus.size());
+            if (!arquivo){
+                cerr << "Erro ao gravar " << caminho << endl;
+                return 1;
+            }
+        }
+        size_t bytes = corpus.size();
+        corpus = string();      // libera a memoria antes de medir os processos
+
+        imprimir(mistura, "analisador", bytes, contagem, medir_processo(opcoes.analisador, caminho, opcoes.repeticoes));
+        imprimir(mistura, "lexico", bytes, contagem, medir_processo(opcoes.lexico, caminho, opcoes.repeticoes));
+        remove(caminho.c_str());
+#endif
+    }
+    return 0;
+}
@@ -0,0 +1,667 @@
+// Compiladores 2025.1 - Bytecode dos programas C--
+//
+// Traduz a Arvore (ast.h) para um bytecode de registradores executado pela
+// maquina virtual de vm.h. Cada instrucao tem o codigo e ate tres operandos
+// de 32 bits (16 bytes); os operandos indexam um unico vetor de
+// registradores de 8 bytes:
+//
+//   [variaveis e constantes, na ordem em que aparecem][temporarios]
+//
+// As variaveis e as constantes ficam em registradores fixos (as constantes
+// ja vem preenchidas em registradores_iniciais), entao "x = x + 1" vira uma
+// unica instrucao ADD_I x, x, k1. Os temporarios guardam os resultados
+// intermediarios de uma expressao e sao reaproveitados a cada comando.
+//
+// Os tipos sao resolvidos na compilacao: int, char e bool sao inteiros de
+// 64 bits e float eh double, com instrucoes separadas para cada um (nada eh
+// verificado durante a execucao). Misturar int e float converte para float;
+// atribuir um float a um int trunca. Comparacoes, '!', '&&' e '||' valem
+// 0 ou 1, e '&&'/'||' so avaliam o segundo operando quando preciso.
+//
+// Semantica dos comandos: todas as variaveis ficam num unico escopo, valem
+// do ponto da declaracao em diante e comecam com 0 (tambem a cada volta de
+// um while que as declara); print escreve o valor e uma quebra de linha;
+// readln le um numero da entrada; return encerra o programa com o valor
+// (inteiro) como codigo de saida.
+
+#ifndef BYTECODE_H
+#define BYTECODE_H
+
+#include <cstdint>
+#include <cstring>      // memcpy
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "ast.h"
+#include "linhas.h"
+#include "saida.h"      // CanalSaida
+
+// Codigos das instrucoes. Operandos: d = destino, a/b = registradores
+// lidos, alvo = indice da instrucao de destino do desvio
+enum codigos_bytecode : uint32_t {
+    op_mov,                                     // d, a
+    op_add_i, op_sub_i, op_mul_i, op_div_i, op_mod_i,   // d, a, b
+    op_add_f, op_sub_f, op_mul_f, op_div_f,
+    op_neg_i, op_neg_f, op_not_i,               // d, a
+    op_lt_i, op_le_i, op_gt_i, op_ge_i, op_eq_i, op_ne_i,   // d, a, b (d = 0 ou 1)
+    op_lt_f, op_le_f, op_gt_f, op_ge_f, op_eq_f, op_ne_f,
+    op_i2f, op_f2i,                             // d, a
+    op_inc_i, op_dec_i, op_inc_f, op_dec_f,     // d (d += 1 ou d -= 1)
+    op_jmp,                                     // alvo
+    op_jz, op_jnz,                              // a, alvo (inteiro igual ou diferente de 0)
+    op_jlt_i, op_jle_i, op_jgt_i, op_jge_i, op_jeq_i, op_jne_i,     // a, b, alvo
+    op_print_i, op_print_f,                     // a
+    op_read_i, op_read_f,                       // d
+    op_ret,                                     // a (codigo de saida)
+    total_codigos_bytecode
+};
+
+constexpr const char* nomes_bytecode[total_codigos_bytecode] = {
+    "MOV",
+    "ADD_I", "SUB_I", "MUL_I", "DIV_I", "MOD_I",
+    "ADD_F", "SUB_F", "MUL_F", "DIV_F",
+    "NEG_I", "NEG_F", "NOT_I",
+    "LT_I", "LE_I", "GT_I", "GE_I", "EQ_I", "NE_I",
+    "LT_F", "LE_F", "GT_F", "GE_F", "EQ_F", "NE_F",
+    "I2F", "F2I",
+    "INC_I", "DEC_I", "INC_F", "DEC_F",
+    "JMP",
+    "JZ", "JNZ",
+    "JLT_I", "JLE_I", "JGT_I", "JGE_I", "JEQ_I", "JNE_I",
+    "PRINT_I", "PRINT_F",
+    "READ_I", "READ_F",
+    "RET"
+};
+
+struct Instrucao {
+    uint32_t op;
+    uint32_t a = 0, b = 0, c = 0;
+};
+
+// Conteudo de um registrador: o tipo eh conhecido pela instrucao que o le
+union Valor {
+    int64_t i;
+    double f;
+};
+
+// O que ocupa cada registrador fixo (so para a listagem)
+enum classes_registrador : uint8_t {
+    variavel_int, variavel_float, constante_int, constante_float
+};
+
+struct ProgramaBytecode {
+    std::vector<Instrucao> codigo;
+    std::vector<size_t> offsets;                // no fonte de cada instrucao (erros de execucao)
+    std::vector<Valor> registradores_iniciais;  // variaveis zeradas, constantes e temporarios zerados
+    std::vector<classes_registrador> fixos;     // classe de cada registrador antes dos temporarios
+};
+
+// Erros encontrados na traducao (o programa nao eh executado)
+enum categorias_erro_semantico : uint8_t {
+    erro_variavel_nao_declarada,
+    erro_variavel_redeclarada,
+    erro_break_fora_de_laco,
+    erro_resto_float,           // '%' com operando float
+    erro_expressao_profunda,    // mais de max_profundidade niveis (ex.: 1 + 1 + ... + 1)
+};
+
+struct ErroSemantico {
+    categorias_erro_semantico categoria;
+    size_t offset;
+    std::string_view nome;      // variavel envolvida, se houver
+};
+
+class CompiladorBytecode {
+public:
+    // a traducao das expressoes eh recursiva; o parser limita parenteses e
+    // operadores unarios, mas uma cadeia como 1 + 1 + ... + 1 vira uma
+    // arvore tao funda quanto o numero de termos
+    static constexpr int max_profundidade = 10000;
+
+    std::vector<ErroSemantico> erros;
+
+    CompiladorBytecode(const Arvore& arvore, const TabelaSimbolos& simbolos)
+        : arvore(arvore), simbolos(simbolos), variaveis(simbolos.tamanho()) {}
+
+    // traduz a arvore inteira; retorna false (com 'erros' preenchido) se o
+    // programa tem erros semanticos
+    bool compilar(ProgramaBytecode& programa){
+        saida = &programa;
+        programa = ProgramaBytecode();
+
+        zero_i = constante_inteira(0);
+        zero_f = constante_real(0);
+        um_i = constante_inteira(1);
+
+        comando(arvore.raiz);
+        emitir(op_ret, zero_i);
+
+        // os temporarios ficam depois das variaveis e constantes, que so
+        // agora tem total
+        uint32_t base_temporarios = (uint32_t)programa.registradores_iniciais.size();
+        for (Instrucao& instrucao : programa.codigo){
+            for (uint32_t* operando : {&instrucao.a, &instrucao.b, &instrucao.c}){
+                if (eh_registrador(instrucao.op, operando - &instrucao.a) && (*operando & marca_temporario))
+                    *operando = base_temporarios + (*operando & ~marca_temporario);
+            }
+        }
+        programa.registradores_iniciais.resize(base_temporarios + max_temporarios, Valor{0});
+        return erros.empty();
+    }
+
+private:
+    // temporarios sao numerados a parte ate o fim da traducao
+    static constexpr uint32_t marca_temporario = 0x80000000u;
+    static constexpr uint32_t sem_registrador = 0xffffffffu;
+
+    enum tipos_valor : uint8_t { tipo_int, tipo_float };
+
+    struct Variavel {
+        uint32_t registrador = sem_registrador;
+        tipos_valor tipo = tipo_int;
+    };
+
+    // registrador com o resultado de uma expressao
+    struct Operando {
+        uint32_t registrador;
+        tipos_valor tipo;
+    };
+
+    const Arvore& arvore;
+    const TabelaSimbolos& simbolos;
+    ProgramaBytecode* saida = nullptr;
+    std::vector<Variavel> variaveis;    // por id de simbolo
+    std::unordered_map<uint64_t, uint32_t> constantes_int, constantes_float;   // bits -> registrador
+    uint32_t zero_i = 0, zero_f = 0, um_i = 0;
+    uint32_t proximo_temporario = 0, max_temporarios = 0;
+    std::vector<std::vector<size_t>> saidas_lacos;  // desvios dos breaks de cada while aberto
+    size_t offset_atual = 0;
+    int profundidade = 0;
+    bool profunda_demais = false;
+
+    // quais operandos de cada instrucao sao registradores (e nao alvos)
+    static bool eh_registrador(uint32_t op, std::ptrdiff_t indice){
+        switch (op){
+            case op_jmp: return false;
+            case op_jz: case op_jnz: return indice == 0;
+            case op_jlt_i: case op_jle_i: case op_jgt_i: case op_jge_i: case op_jeq_i: case op_jne_i:
+                return indice < 2;
+            case op_mov: case op_neg_i: case op_neg_f: case op_not_i: case op_i2f: case op_f2i:
+                return indice < 2;
+            case op_inc_i: case op_dec_i: case op_inc_f: case op_dec_f:
+            case op_print_i: case op_print_f: case op_read_i: case op_read_f: case op_ret:
+                return indice == 0;
+            default: return true;
+        }
+    }
+
+    size_t emitir(uint32_t op, uint32_t a = 0, uint32_t b = 0, uint32_t c = 0){
+        saida->codigo.push_back({op, a, b, c});
+        saida->offsets.push_back(offset_atual);
+        return saida->codigo.size() - 1;
+    }
+
+    // o alvo eh o ultimo operando de cada desvio
+    void apontar(size_t indice, uint32_t alvo){
+        Instrucao& salto = saida->codigo[indice];
+        if (salto.op == op_jmp) salto.a = alvo;
+        else if (salto.op == op_jz || salto.op == op_jnz) salto.b = alvo;
+        else salto.c = alvo;
+    }
+
+    // o desvio 'indice' passa a apontar para a proxima instrucao
+    void ajustar(size_t indice){ apontar(indice, (uint32_t)saida->codigo.size()); }
+
+    uint32_t temporario(){
+        uint32_t t = proximo_temporario++;
+        if (proximo_temporario > max_temporarios) max_temporarios = proximo_temporario;
+        return marca_temporario | t;
+    }
+
+    uint32_t registrador_fixo(Valor valor, classes_registrador classe){
+        saida->registradores_iniciais.push_back(valor);
+        saida->fixos.push_back(classe);
+        return (uint32_t)saida->registradores_iniciais.size() - 1;
+    }
+
+    uint32_t constante_inteira(int64_t valor){
+        uint64_t bits = (uint64_t)valor;
+        auto [posicao, nova] = constantes_int.try_emplace(bits, 0);
+        if (nova) posicao->second = registrador_fixo(Valor{valor}, constante_int);
+        return posicao->second;
+    }
+
+    uint32_t constante_real(double valor){
+        uint64_t bits;
+        memcpy(&bits, &valor, sizeof bits);
+        auto [posicao, nova] = constantes_float.try_emplace(bits, 0);
+        if (nova){
+            Valor v;
+            v.f = valor;
+            posicao->second = registrador_fixo(v, constante_float);
+        }
+        return posicao->second;
+    }
+
+    void reportar(categorias_erro_semantico categoria, const No& no){
+        std::string_view nome = no.simbolo != sem_simbolo ? simbolos.nome(no.simbolo) : std::string_view();
+        erros.push_back({categoria, no.offset, nome});
+    }
+
+    // cria o registrador da variavel (um escopo so: declarar de novo eh erro)
+    const Variavel* declarar(const No& variavel, tipos_token tipo){
+        if (variavel.simbolo == sem_simbolo) return nullptr;
+        Variavel& destino = variaveis[variavel.simbolo];
+        if (destino.registrador != sem_registrador){
+            reportar(erro_variavel_redeclarada, variavel);
+            return nullptr;
+        }
+        destino.tipo = tipo == tk_float ? tipo_float : tipo_int;
+        destino.registrador = registrador_fixo(Valor{0}, destino.tipo == tipo_float ? variavel_float : variavel_int);
+        return &destino;
+    }
+
+    // variavel de um no id (ou variavel); nullptr se nao foi declarada
+    const Variavel* variavel(const No& no){
+        if (no.simbolo != sem_simbolo && variaveis[no.simbolo].registrador != sem_registrador)
+            return &variaveis[no.simbolo];
+        reportar(erro_variavel_nao_declarada, no);
+        return nullptr;
+    }
+
+    void comando(uint32_t indice){
+        const No& no = arvore[indice];
+        offset_atual = no.offset;
+        uint32_t primeiro = no.filho;
+        uint32_t marca = proximo_temporario;
+        switch (no.tipo){
+            case no_programa:
+            case no_bloco:
+                for (uint32_t f = primeiro; f != sem_no; f = arvore[f].irmao) comando(f);
+                break;
+            case no_declaracao:
+                for (uint32_t v = primeiro; v != sem_no; v = arvore[v].irmao){
+                    // o valor inicial eh calculado antes: em "int x = x;" o x ainda nao existe
+                    const No& var = arvore[v];
+                    offset_atual = var.offset;
+                    if (var.filho == sem_no){
+                        // o registrador ja comeca com 0; dentro de um while
+                        // a declaracao zera de novo a cada volta
+                        const Variavel* destino = declarar(var, no.operador);
+                        if (destino && !saidas_lacos.empty())
+                            emitir(op_mov, destino->registrador, destino->tipo == tipo_float ? zero_f : zero_i);
+                        continue;
+                    }
+                    uint32_t marca_valor = proximo_temporario;
+                    Operando valor = expressao(var.filho);
+                    const Variavel* destino = declarar(var, no.operador);
+                    if (destino) converter(valor, destino->registrador, destino->tipo);
+                    proximo_temporario = marca_valor;
+                }
+                break;
+            case no_if: {
+                uint32_t entao = arvore[primeiro].irmao;
+                uint32_t senao = arvore[entao].irmao;
+                size_t falso = desviar(primeiro, false);
+                comando(entao);
+                if (senao == sem_no){
+                    ajustar(falso);
+                } else {
+                    size_t fim = emitir(op_jmp);
+                    ajustar(falso);
+                    comando(senao);
+                    ajustar(fim);
+                }
+                break;
+            }
+            case no_while: {
+                // o teste fica no fim do laco: um desvio so por volta
+                size_t teste = emitir(op_jmp);
+                uint32_t inicio = (uint32_t)saida->codigo.size();
+                saidas_lacos.emplace_back();
+                comando(arvore[primeiro].irmao);
+                ajustar(teste);
+                offset_atual = no.offset;
+                apontar(desviar(primeiro, true), inicio);
+                for (size_t saida_laco : saidas_lacos.back()) ajustar(saida_laco);
+                saidas_lacos.pop_back();
+                break;
+            }
+            case no_break:
+                if (saidas_lacos.empty()) reportar(erro_break_fora_de_laco, no);
+                else saidas_lacos.back().push_back(emitir(op_jmp));
+                break;
+            case no_print: {
+                Operando valor = expressao(primeiro);
+                emitir(valor.tipo == tipo_float ? op_print_f : op_print_i, valor.registrador);
+                break;
+            }
+            case no_readln: {
+                const Variavel* destino = variavel(arvore[primeiro]);
+                if (destino) emitir(destino->tipo == tipo_float ? op_read_f : op_read_i, destino->registrador);
+                break;
+            }
+            case no_return: {
+                uint32_t codigo = zero_i;
+                if (primeiro != sem_no) codigo = inteiro(expressao(primeiro));
+                emitir(op_ret, codigo);
+                break;
+            }
+            case no_expressao:
+                efeito(primeiro);
+                break;
+            default:
+                break;
+        }
+        proximo_temporario = marca;
+    }
+
+    // expressao cujo valor eh descartado: x++ e x = y nao precisam de copia
+    void efeito(uint32_t indice){
+        const No& no = arvore[indice];
+        if (no.tipo == no_incremento){
+            const Variavel* alvo = variavel(arvore[no.filho]);
+            if (alvo) incrementar(*alvo, no.operador);
+        } else if (no.tipo == no_atribuicao){
+            const Variavel* alvo = variavel(arvore[no.filho]);
+            if (alvo) expressao_em(arvore[no.filho].irmao, alvo->registrador, alvo->tipo);
+        } else {
+            expressao(indice);
+        }
+    }
+
+    void incrementar(const Variavel& alvo, tipos_token operador){
+        bool mais = operador == tk_increment;
+        if (alvo.tipo == tipo_float) emitir(mais ? op_inc_f : op_dec_f, alvo.registrador);
+        else emitir(mais ? op_inc_i : op_dec_i, alvo.registrador);
+    }
+
+    // calcula a expressao direto em 'destino', convertendo para 'tipo'
+    void expressao_em(uint32_t indice, uint32_t destino, tipos_valor tipo){
+        uint32_t marca = proximo_temporario;
+        converter(expressao(indice, destino), destino, tipo);
+        proximo_temporario = marca;
+    }
+
+    // copia o valor para 'destino' (se ja nao estiver la), convertendo para
+    // 'tipo'; I2F e F2I funcionam mesmo com o valor ja em 'destino'
+    void converter(Operando valor, uint32_t destino, tipos_valor tipo){
+        if (valor.tipo != tipo) emitir(tipo == tipo_float ? op_i2f : op_f2i, destino, valor.registrador);
+        else if (valor.registrador != destino) emitir(op_mov, destino, valor.registrador);
+    }
+
+    uint32_t inteiro(Operando valor){
+        if (valor.tipo == tipo_int) return valor.registrador;
+        uint32_t t = temporario();
+        emitir(op_f2i, t, valor.registrador);
+        return t;
+    }
+
+    uint32_t real(Operando valor){
+        if (valor.tipo == tipo_float) return valor.registrador;
+        uint32_t t = temporario();
+        emitir(op_i2f, t, valor.registrador);
+        return t;
+    }
+
+    // valor de verdade (0 ou 1) de um operando qualquer
+    uint32_t verdade(Operando valor, uint32_t destino){
+        if (valor.tipo == tipo_float) emitir(op_ne_f, destino, valor.registrador, zero_f);
+        else emitir(op_ne_i, destino, valor.registrador, zero_i);
+        return destino;
+    }
+
+    // Traduz a expressao e devolve onde ficou o valor. Com 'preferido' o
+    // resultado de uma operacao vai direto para ele (mas ids e constantes
+    // devolvem o proprio registrador, sem copia)
+    Operando expressao(uint32_t indice, uint32_t preferido = sem_registrador){
+        if (profundidade >= max_profundidade){
+            if (!profunda_demais) reportar(erro_expressao_profunda, arvore[indice]);
+            profunda_demais = true;     // um erro so por programa
+            return {zero_i, tipo_int};
+        }
+        profundidade++;
+        Operando valor = traduzir(indice, preferido);
+        profundidade--;
+        return valor;
+    }
+
+    Operando traduzir(uint32_t indice, uint32_t preferido){
+        const No& no = arvore[indice];
+        auto destino = [&]{ return preferido != sem_registrador ? preferido : temporario(); };
+        switch (no.tipo){
+            case no_inteiro:
+                return {constante_inteira(no.valor.inteiro), tipo_int};
+            case no_booleano:
+                return {no.valor.inteiro ? um_i : zero_i, tipo_int};
+            case no_real:
+                return {constante_real(no.valor.real), tipo_float};
+            case no_id: {
+                const Variavel* var = variavel(no);
+                if (!var) return {zero_i, tipo_int};
+                return {var->registrador, var->tipo};
+            }
+            case no_atribuicao: {
+                const Variavel* alvo = variavel(arvore[no.filho]);
+                if (!alvo) return {zero_i, tipo_int};
+                expressao_em(arvore[no.filho].irmao, alvo->registrador, alvo->tipo);
+                return {alvo->registrador, alvo->tipo};
+            }
+            case no_incremento: {
+                const Variavel* alvo = variavel(arvore[no.filho]);
+                if (!alvo) return {zero_i, tipo_int};
+                if (no.valor.inteiro){      // ++x: o valor ja incrementado
+                    incrementar(*alvo, no.operador);
+                    return {alvo->registrador, alvo->tipo};
+                }
+                uint32_t antigo = destino();
+                emitir(op_mov, antigo, alvo->registrador);
+                incrementar(*alvo, no.operador);
+                return {antigo, alvo->tipo};
+            }
+            case no_unario: {
+                Operando valor = expressao(no.filho);
+                uint32_t d = destino();
+                if (no.operador == tk_neg){
+                    emitir(op_not_i, d, valor.tipo == tipo_float ? verdade(valor, d) : valor.registrador);
+                    return {d, tipo_int};
+                }
+                emitir(valor.tipo == tipo_float ? op_neg_f : op_neg_i, d, valor.registrador);
+                return {d, valor.tipo};
+            }
+            case no_binario:
+                return binario(no, preferido);
+            default:
+                return {zero_i, tipo_int};
+        }
+    }
+
+    Operando binario(const No& no, uint32_t preferido){
+        uint32_t esquerda = no.filho, direita = arvore[esquerda].irmao;
+
+        // && e ||: o segundo operando so eh avaliado se o primeiro nao decide.
+        // O resultado vai para um temporario mesmo com 'preferido', que pode
+        // ser lido pelo segundo operando depois de o primeiro ja ter escrito
+        if (no.operador == tk_and || no.operador == tk_or){
+            uint32_t d = temporario();
+            uint32_t marca = proximo_temporario;
+            verdade(expressao(esquerda), d);
+            proximo_temporario = marca;
+            offset_atual = no.offset;
+            size_t salto = emitir(no.operador == tk_and ? op_jz : op_jnz, d);
+            verdade(expressao(direita), d);
+            proximo_temporario = marca;
+            ajustar(salto);
+            return {d, tipo_int};
+        }
+
+        uint32_t marca = proximo_temporario;
+        Operando a = expressao(esquerda);
+        Operando b = expressao(direita);
+        bool em_float = a.tipo == tipo_float || b.tipo == tipo_float;
+        uint32_t ra = em_float ? real(a) : a.registrador;
+        uint32_t rb = em_float ? real(b) : b.registrador;
+        proximo_temporario = marca;     // os operandos ja foram lidos quando d eh escrito
+        uint32_t d = preferido != sem_registrador ? preferido : temporario();
+        offset_atual = no.offset;     // divisao por zero aponta o operador
+
+        uint32_t op;
+        switch (no.operador){
+            case tk_plus: op = em_float ? op_add_f : op_add_i; break;
+            case tk_minus: op = em_float ? op_sub_f : op_sub_i; break;
+            case tk_mult: op = em_float ? op_mul_f : op_mul_i; break;
+            case tk_div: op = em_float ? op_div_f : op_div_i; break;
+            case tk_mod:
+                if (em_float) reportar(erro_resto_float, no);
+                op = op_mod_i;
+                break;
+            default:
+                op = comparacao(no.operador, em_float);
+                emitir(op, d, ra, rb);
+                return {d, tipo_int};
+        }
+        emitir(op, d, ra, rb);
+        return {d, em_float ? tipo_float : tipo_int};
+    }
+
+    static uint32_t comparacao(tipos_token operador, bool em_float){
+        uint32_t base = em_float ? op_lt_f : op_lt_i;
+        switch (operador){
+            case tk_lt: return base;
+            case tk_leq: return base + 1;
+            case tk_gt: return base + 2;
+            case tk_geq: return base + 3;
+            case tk_eq: return base + 4;
+            default: return base + 5;     // tk_diff
+        }
+    }
+
+    // Emite o desvio tomado quando a condicao vale 'se_verdadeiro' e devolve
+    // o indice dele, para ajustar o alvo depois. Comparacoes de inteiros
+    // viram um desvio so (JLT_I a, b, alvo), sem calcular o 0 ou 1
+    size_t desviar(uint32_t indice, bool se_verdadeiro){
+        const No& no = arvore[indice];
+        uint32_t marca = proximo_temporario;
+        size_t salto;
+        if (no.tipo == no_binario && eh_comparacao(no.operador)){
+            uint32_t esquerda = no.filho;
+            Operando a = expressao(esquerda);
+            Operando b = expressao(arvore[esquerda].irmao);
+            if (a.tipo == tipo_int && b.tipo == tipo_int){
+                static const uint32_t desvios[] = {op_jlt_i, op_jle_i, op_jgt_i, op_jge_i, op_jeq_i, op_jne_i};
+                static const uint32_t negados[] = {op_jge_i, op_jgt_i, op_jle_i, op_jlt_i, op_jne_i, op_jeq_i};
+                uint32_t k = comparacao(no.operador, false) - op_lt_i;
+                salto = emitir(se_verdadeiro ? desvios[k] : negados[k], a.registrador, b.registrador);
+            } else {
+                uint32_t t = temporario();
+                emitir(comparacao(no.operador, true), t, real(a), real(b));
+                salto = emitir(se_verdadeiro ? op_jnz : op_jz, t);
+            }
+        } else {
+            Operando valor = expressao(indice);
+            uint32_t r = valor.registrador;
+            if (valor.tipo == tipo_float) r = verdade(valor, temporario());
+            salto = emitir(se_verdadeiro ? op_jnz : op_jz, r);
+        }
+        proximo_temporario = marca;
+        return salto;
+    }
+
+    static bool eh_comparacao(tipos_token operador){
+        switch (operador){
+            case tk_lt: case tk_leq: case tk_gt: case tk_geq: case tk_eq: case tk_diff: return true;
+            default: return false;
+        }
+    }
+};
+
+// "Encontrado ERRO SEMANTICO na linha L, coluna C: variavel 'x' nao declarada"
+inline void formatar_erro_semantico(CanalSaida& canal, const ErroSemantico& erro, PosicaoTexto posicao, bool cor){
+    if (cor) canal.escrever("\033[31m");
+    canal.escrever("Encontrado ERRO SEMÂNTICO na linha ");
+    canal.escrever_numero(posicao.linha);
+    canal.escrever(", coluna ");
+    canal.escrever_numero(posicao.coluna);
+    switch (erro.categoria){
+        case erro_variavel_nao_declarada:
+            canal.escrever(": variável '");
+            canal.escrever(erro.nome);
+            canal.escrever("' não declarada");
+            break;
+        case erro_variavel_redeclarada:
+            canal.escrever(": variável '");
+            canal.escrever(erro.nome);
+            canal.escrever("' já declarada");
+            break;
+        case erro_break_fora_de_laco:
+            canal.escrever(": break fora de um laço");
+            break;
+        case erro_expressao_profunda:
+            canal.escrever(": expressão aninhada demais");
+            break;
+        default:
+            canal.escrever(": operador '%' exige operandos inteiros");
+            break;
+    }
+    if (cor) canal.escrever("\033[0m");
+    canal.escrever("\n");
+}
+
+// Listagem do bytecode, uma instrucao por linha: "12  ADD_I v0, v0, k1(1)".
+// Os registradores aparecem como v (variavel), k (constante, com o valor)
+// ou t (temporario), numerados pelo indice no vetor de registradores
+inline void escrever_bytecode(CanalSaida& canal, const ProgramaBytecode& programa){
+    auto registrador = [&](uint32_t r){
+        if (r >= programa.fixos.size()){
+            canal.escrever("t");
+            canal.escrever_numero(r);
+            return;
+        }
+        classes_registrador classe = programa.fixos[r];
+        canal.escrever(classe == variavel_int || classe == variavel_float ? "v" : "k");
+        canal.escrever_numero(r);
+        if (classe == constante_int || classe == constante_float){
+            canal.escrever("(");
+            if (classe == constante_int) canal.escrever_numero(programa.registradores_iniciais[r].i);
+            else canal.escrever_real(programa.registradores_iniciais[r].f);
+            canal.escrever(")");
+        }
+    };
+    for (size_t i = 0; i < programa.codigo.size(); i++){
+        const Instrucao& instrucao = programa.codigo[i];
+        canal.escrever_numero((int64_t)i);
+        canal.escrever("  ");
+        canal.escrever(nomes_bytecode[instrucao.op]);
+        const uint32_t operandos[] = {instrucao.a, instrucao.b, instrucao.c};
+        int total;
+        switch (instrucao.op){
+            case op_jmp: case op_inc_i: case op_dec_i: case op_inc_f: case op_dec_f:
+            case op_print_i: case op_print_f: case op_read_i: case op_read_f: case op_ret:
+                total = 1;
+                break;
+            case op_mov: case op_neg_i: case op_neg_f: case op_not_i: case op_i2f: case op_f2i:
+            case op_jz: case op_jnz:
+                total = 2;
+                break;
+            default:
+                total = 3;
+                break;
+        }
+        // o ultimo operando dos desvios eh o indice da instrucao de destino
+        bool desvio = instrucao.op >= op_jmp && instrucao.op <= op_jne_i;
+        for (int k = 0; k < total; k++){
+            canal.escrever(k == 0 ? " " : ", ");
+            if (desvio && k == total - 1){
+                canal.escrever("@");
+                canal.escrever_numero(operandos[k]);
+            } else {
+                registrador(operandos[k]);
+            }
+        }
+        canal.escrever("\n");
+        canal.verificar();
+    }
+}
+
+#endif
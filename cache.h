@@ -0,0 +1,399 @@
+// Compiladores 2025.1 - Cache de tokens
+//
+// Guarda em disco os tokens e diagnosticos de cada arquivo analisado (opcao
+// --cache=diretorio), indexados pelo hash do conteudo (XXH64), pelo tamanho
+// e pela versao do Lexer. Na proxima analise do mesmo conteudo os tokens sao
+// reproduzidos do cache em vez de passar pelo Lexer.
+//
+// Layout de um arquivo do cache (inteiros na ordem nativa da maquina, com
+// registros de tamanho fixo, lidos direto do mapeamento sem decodificar):
+//   CabecalhoCache
+//   RegistroTokenCache[total_tokens]              incluindo o EOF
+//   RegistroDiagnosticoCache[total_diagnosticos]
+// O lexema nao eh guardado: offset e tamanho apontam para o proprio fonte,
+// que eh lido de qualquer forma para calcular o hash.
+//
+// Cada entrada eh gravada num arquivo temporario do mesmo diretorio e so
+// depois renomeada para o nome final (rename eh atomico), entao processos
+// concorrentes nunca leem uma entrada pela metade; dois processos gravando a
+// mesma entrada produzem o mesmo conteudo e o ultimo rename vence. Uma
+// entrada lida tem a data de modificacao renovada e, quando o diretorio passa
+// do limite de tamanho, as entradas usadas ha mais tempo sao apagadas.
+
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <algorithm>        // sort
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>           // snprintf
+#include <cstring>          // memcpy, memcmp
+#include <filesystem>
+#include <fstream>
+#include <memory>           // unique_ptr
+#include <string>
+#include <system_error>
+#include <vector>
+
+#ifdef _WIN32
+#include <process.h>        // _getpid
+#endif
+
+#include "entrada.h"        // ArquivoMapeado
+#include "lexer.h"          // Token, Diagnostico, versao_lexer
+#include "linhas.h"
+#include "saida.h"          // Saida
+
+// ---------------------------------------------------------------------------
+// XXH64 (semente 0): ~10 GB/s, bem mais rapido que o proprio Lexer
+
+constexpr uint64_t primo64_1 = 0x9E3779B185EBCA87ull;
+constexpr uint64_t primo64_2 = 0xC2B2AE3D27D4EB4Full;
+constexpr uint64_t primo64_3 = 0x165667B19E3779F9ull;
+constexpr uint64_t primo64_4 = 0x85EBCA77C2B2AE63ull;
+constexpr uint64_t primo64_5 = 0x27D4EB2F165667C5ull;
+
+inline uint64_t rotacionar64(uint64_t x, int r){ return (x << r) | (x >> (64 - r)); }
+
+inline uint64_t ler64(const char* p){ uint64_t v; std::memcpy(&v, p, 8); return v; }
+inline uint32_t ler32(const char* p){ uint32_t v; std::memcpy(&v, p, 4); return v; }
+
+inline uint64_t rodada_xxh64(uint64_t acumulado, uint64_t entrada){
+    acumulado += entrada * primo64_2;
+    return rotacionar64(acumulado, 31) * primo64_1;
+}
+
+inline uint64_t juntar_xxh64(uint64_t hash, uint64_t acumulado){
+    hash ^= rodada_xxh64(0, acumulado);
+    return hash * primo64_1 + primo64_4;
+}
+
+inline uint64_t hash_conteudo(const char* p, size_t n){
+    const char* fim = p + n;
+    uint64_t hash;
+    if (n >= 32){
+        uint64_t v1 = primo64_1 + primo64_2, v2 = primo64_2, v3 = 0, v4 = 0 - primo64_1;
+        for (; fim - p >= 32; p += 32){
+            v1 = rodada_xxh64(v1, ler64(p));
+            v2 = rodada_xxh64(v2, ler64(p + 8));
+            v3 = rodada_xxh64(v3, ler64(p + 16));
+            v4 = rodada_xxh64(v4, ler64(p + 24));
+        }
+        hash = rotacionar64(v1, 1) + rotacionar64(v2, 7) + rotacionar64(v3, 12) + rotacionar64(v4, 18);
+        hash = juntar_xxh64(hash, v1);
+        hash = juntar_xxh64(hash, v2);
+        hash = juntar_xxh64(hash, v3);
+        hash = juntar_xxh64(hash, v4);
+    } else {
+        hash = primo64_5;
+    }
+    hash += n;
+    for (; fim - p >= 8; p += 8)
+        hash = rotacionar64(hash ^ rodada_xxh64(0, ler64(p)), 27) * primo64_1 + primo64_4;
+    if (fim - p >= 4){
+        hash = rotacionar64(hash ^ ((uint64_t)ler32(p) * primo64_1), 23) * primo64_2 + primo64_3;
+        p += 4;
+    }
+    for (; p < fim; p++)
+        hash = rotacionar64(hash ^ ((uint64_t)(unsigned char)*p * primo64_5), 11) * primo64_1;
+    hash ^= hash >> 33;
+    hash *= primo64_2;
+    hash ^= hash >> 29;
+    hash *= primo64_3;
+    hash ^= hash >> 32;
+    return hash;
+}
+
+// ---------------------------------------------------------------------------
+// Formato da entrada
+
+constexpr char assinatura_cache[4] = {'C', '-', '-', 'C'};
+constexpr uint32_t versao_cache = 1;
+constexpr uint32_t marca_ordem_bytes = 0x01020304;    // rejeita caches de outra arquitetura
+
+struct CabecalhoCache {
+    char assinatura[4];
+    uint32_t versao;
+    uint32_t versao_lexer;
+    uint32_t ordem_bytes;
+    uint64_t hash;
+    uint64_t tamanho_fonte;
+    uint64_t total_tokens;
+    uint64_t total_diagnosticos;
+};
+
+struct RegistroTokenCache {
+    uint64_t offset;
+    ValorNumero valor;
+    uint32_t tamanho;
+    uint8_t tipo;
+};
+
+struct RegistroDiagnosticoCache {
+    uint64_t offset;
+    uint64_t antes_do_token;    // indice do token que vem logo depois do erro
+    uint32_t tamanho;
+    uint8_t categoria;
+};
+
+// Identifica um conteudo no cache
+struct ChaveCache {
+    uint64_t hash = 0;
+    uint64_t tamanho = 0;
+};
+
+inline ChaveCache chave_cache(const char* fonte, size_t tamanho){
+    return {hash_conteudo(fonte, tamanho), tamanho};
+}
+
+// extensao das entradas (os temporarios terminam em .tmp)
+constexpr const char* extensao_cache = ".ctk";
+
+// ---------------------------------------------------------------------------
+// Gravacao: repassa tokens e erros para outra Saida e, no caminho, os grava
+// no arquivo temporario da entrada. Ao final, concluir() escreve o cabecalho
+// e publica a entrada com rename; sem concluir() o temporario eh descartado.
+class SaidaGravacaoCache : public Saida {
+public:
+    SaidaGravacaoCache(Saida& destino, std::filesystem::path temporario, std::filesystem::path final,
+                       ChaveCache chave)
+        : destino(destino), temporario(std::move(temporario)), final(std::move(final)), chave(chave) {
+        arquivo.open(this->temporario, std::ios::binary | std::ios::trunc);
+        CabecalhoCache vazio{};
+        arquivo.write((const char*)&vazio, sizeof vazio);   // reescrito em concluir()
+        registros.reserve(tokens_por_bloco);
+    }
+
+    ~SaidaGravacaoCache(){
+        if (!concluida){
+            arquivo.close();
+            std::error_code erro;
+            std::filesystem::remove(temporario, erro);
+        }
+    }
+
+    void usar_linhas(IndiceLinhas* indice) override {
+        linhas = indice;
+        destino.usar_linhas(indice);
+    }
+
+    void token(const Token& token) override {
+        RegistroTokenCache registro{};
+        registro.offset = token.offset;
+        registro.valor = token.valor;
+        registro.tamanho = (uint32_t)token.lexema.size();
+        registro.tipo = (uint8_t)token.tipo;
+        registros.push_back(registro);
+        tokens_gravados++;
+        if (registros.size() == tokens_por_bloco) descarregar();
+        destino.token(token);
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        RegistroDiagnosticoCache registro{};
+        registro.offset = erro.offset;
+        registro.antes_do_token = tokens_gravados;
+        registro.tamanho = (uint32_t)erro.lexema.size();
+        registro.categoria = (uint8_t)erro.categoria;
+        diagnosticos.push_back(registro);
+        destino.diagnostico(erro);
+    }
+
+    // publica a entrada; retorna o tamanho gravado (0 se nao foi possivel)
+    uint64_t concluir(){
+        descarregar();
+        arquivo.write((const char*)diagnosticos.data(),
+                      (std::streamsize)(diagnosticos.size() * sizeof(RegistroDiagnosticoCache)));
+        CabecalhoCache cabecalho{};
+        std::memcpy(cabecalho.assinatura, assinatura_cache, 4);
+        cabecalho.versao = versao_cache;
+        cabecalho.versao_lexer = versao_lexer;
+        cabecalho.ordem_bytes = marca_ordem_bytes;
+        cabecalho.hash = chave.hash;
+        cabecalho.tamanho_fonte = chave.tamanho;
+        cabecalho.total_tokens = tokens_gravados;
+        cabecalho.total_diagnosticos = diagnosticos.size();
+        arquivo.seekp(0);
+        arquivo.write((const char*)&cabecalho, sizeof cabecalho);
+        arquivo.close();
+        if (!arquivo) return 0;
+
+        std::error_code erro;
+        std::filesystem::rename(temporario, final, erro);
+        if (erro) return 0;
+        concluida = true;
+        return sizeof(CabecalhoCache) + tokens_gravados * sizeof(RegistroTokenCache) +
+               diagnosticos.size() * sizeof(RegistroDiagnosticoCache);
+    }
+
+private:
+    static constexpr size_t tokens_por_bloco = 1 << 14;
+
+    Saida& destino;
+    std::filesystem::path temporario, final;
+    ChaveCache chave;
+    std::ofstream arquivo;
+    std::vector<RegistroTokenCache> registros;          // bloco ainda nao gravado
+    std::vector<RegistroDiagnosticoCache> diagnosticos; // vao para o fim do arquivo
+    uint64_t tokens_gravados = 0;
+    bool concluida = false;
+
+    void descarregar(){
+        arquivo.write((const char*)registros.data(), (std::streamsize)(registros.size() * sizeof(RegistroTokenCache)));
+        registros.clear();
+    }
+};
+
+// ---------------------------------------------------------------------------
+// Diretorio do cache
+class CacheTokens {
+public:
+    CacheTokens(std::filesystem::path diretorio, uint64_t limite_bytes)
+        : diretorio(std::move(diretorio)), limite_bytes(limite_bytes) {
+        std::error_code erro;
+        std::filesystem::create_directories(this->diretorio, erro);
+    }
+
+    // se 'chave' esta no cache, entrega a saida os tokens e diagnosticos de
+    // [fonte, fonte + chave.tamanho), na mesma ordem de analisar()
+    bool reproduzir(const ChaveCache& chave, const char* fonte, Saida& saida){
+        std::filesystem::path caminho = caminho_entrada(chave);
+        ArquivoMapeado mapa;
+        if (!mapear_arquivo(caminho.string().c_str(), mapa) || !valida(mapa, chave)) return false;
+
+        CabecalhoCache cabecalho;
+        std::memcpy(&cabecalho, mapa.dados, sizeof cabecalho);
+        const RegistroTokenCache* tokens = (const RegistroTokenCache*)(mapa.dados + sizeof(CabecalhoCache));
+        const RegistroDiagnosticoCache* diagnosticos =
+            (const RegistroDiagnosticoCache*)(tokens + cabecalho.total_tokens);
+
+        IndiceLinhas linhas(fonte, fonte + chave.tamanho);
+        saida.usar_linhas(&linhas);
+        size_t proximo_erro = 0;
+        for (uint64_t i = 0; i < cabecalho.total_tokens; i++){
+            for (; proximo_erro < cabecalho.total_diagnosticos && diagnosticos[proximo_erro].antes_do_token == i;
+                 proximo_erro++){
+                const RegistroDiagnosticoCache& registro = diagnosticos[proximo_erro];
+                saida.diagnostico({(categorias_erro)registro.categoria,
+                                   std::string_view(fonte + registro.offset, registro.tamanho), registro.offset});
+            }
+            const RegistroTokenCache& registro = tokens[i];
+            Token token{(tipos_token)registro.tipo, std::string_view(fonte + registro.offset, registro.tamanho),
+                        registro.offset};
+            token.valor = registro.valor;
+            saida.token(token);
+        }
+        saida.usar_linhas(nullptr);
+
+        // usada agora: fica entre as ultimas a sair na limpeza
+        std::error_code erro;
+        std::filesystem::last_write_time(caminho, std::filesystem::file_time_type::clock::now(), erro);
+        return true;
+    }
+
+    // Saida que grava a entrada de 'chave' enquanto repassa os tokens a
+    // 'destino'; depois da analise, concluir() publica a entrada
+    std::unique_ptr<SaidaGravacaoCache> gravar(const ChaveCache& chave, Saida& destino){
+        // temporario unico por processo e por gravacao
+        static std::atomic<unsigned> sequencia{0};
+#ifdef _WIN32
+        long processo = (long)_getpid();
+#else
+        long processo = (long)getpid();
+#endif
+        char sufixo[64];
+        snprintf(sufixo, sizeof sufixo, ".%ld.%u.tmp", processo, sequencia++);
+        std::filesystem::path final = caminho_entrada(chave);
+        std::filesystem::path temporario = final;
+        temporario += sufixo;
+        return std::make_unique<SaidaGravacaoCache>(destino, temporario, final, chave);
+    }
+
+    // apaga as entradas usadas ha mais tempo ate o diretorio caber no limite
+    // (e os temporarios abandonados por processos interrompidos)
+    void limitar(){
+        namespace fs = std::filesystem;
+        struct Entrada {
+            fs::path caminho;
+            fs::file_time_type modificacao;
+            uint64_t tamanho;
+        };
+        std::vector<Entrada> entradas;
+        uint64_t total = 0;
+        auto agora = fs::file_time_type::clock::now();
+        std::error_code erro;
+        for (fs::directory_iterator it(diretorio, erro), fim; !erro && it != fim; it.increment(erro)){
+            std::error_code erro_entrada;
+            fs::path caminho = it->path();
+            uint64_t tamanho = it->file_size(erro_entrada);
+            fs::file_time_type modificacao = it->last_write_time(erro_entrada);
+            if (erro_entrada) continue;     // apagada por outro processo no meio do caminho
+            if (caminho.extension() == ".tmp"){
+                if (agora - modificacao > std::chrono::hours(1)) fs::remove(caminho, erro_entrada);
+                continue;
+            }
+            if (caminho.extension() != extensao_cache) continue;
+            entradas.push_back({caminho, modificacao, tamanho});
+            total += tamanho;
+        }
+        if (total <= limite_bytes) return;
+
+        std::sort(entradas.begin(), entradas.end(),
+                  [](const Entrada& a, const Entrada& b){ return a.modificacao < b.modificacao; });
+        for (const Entrada& entrada : entradas){
+            if (total <= limite_bytes) break;
+            std::error_code erro_remocao;
+            fs::remove(entrada.caminho, erro_remocao);
+            total -= entrada.tamanho;
+        }
+    }
+
+private:
+    std::filesystem::path diretorio;
+    uint64_t limite_bytes;
+
+    // <hash>-<tamanho>-v<versao do lexer>.ctk
+    std::filesystem::path caminho_entrada(const ChaveCache& chave) const {
+        char nome[80];
+        snprintf(nome, sizeof nome, "%016llx-%llx-v%u%s", (unsigned long long)chave.hash,
+                 (unsigned long long)chave.tamanho, versao_lexer, extensao_cache);
+        return diretorio / nome;
+    }
+
+    // confere o cabecalho e se o tamanho do arquivo bate com as contagens
+    // (uma entrada corrompida ou truncada so vira um miss)
+    static bool valida(const ArquivoMapeado& mapa, const ChaveCache& chave){
+        if (mapa.tamanho < sizeof(CabecalhoCache)) return false;
+        CabecalhoCache cabecalho;
+        std::memcpy(&cabecalho, mapa.dados, sizeof cabecalho);
+        if (std::memcmp(cabecalho.assinatura, assinatura_cache, 4) != 0 || cabecalho.versao != versao_cache ||
+            cabecalho.versao_lexer != versao_lexer || cabecalho.ordem_bytes != marca_ordem_bytes ||
+            cabecalho.hash != chave.hash || cabecalho.tamanho_fonte != chave.tamanho)
+            return false;
+        // cada contagem eh limitada pelos bytes que sobram antes de ser
+        // multiplicada: um valor absurdo nao da a volta e passa na conta
+        uint64_t maximo = (mapa.tamanho - sizeof(CabecalhoCache)) / sizeof(RegistroTokenCache);
+        if (cabecalho.total_tokens == 0 || cabecalho.total_tokens > maximo) return false;
+        uint64_t restante = mapa.tamanho - sizeof(CabecalhoCache) - cabecalho.total_tokens * sizeof(RegistroTokenCache);
+        if (cabecalho.total_diagnosticos > restante / sizeof(RegistroDiagnosticoCache)) return false;
+        if (cabecalho.total_diagnosticos * sizeof(RegistroDiagnosticoCache) != restante) return false;
+
+        // os trechos apontados precisam caber no fonte
+        const RegistroTokenCache* tokens = (const RegistroTokenCache*)(mapa.dados + sizeof(CabecalhoCache));
+        for (uint64_t i = 0; i < cabecalho.total_tokens; i++)
+            if (tokens[i].offset > chave.tamanho || tokens[i].tamanho > chave.tamanho - tokens[i].offset ||
+                tokens[i].tipo >= total_tokens)
+                return false;
+        if (tokens[cabecalho.total_tokens - 1].tipo != tk_eof) return false;
+        const RegistroDiagnosticoCache* diagnosticos =
+            (const RegistroDiagnosticoCache*)(tokens + cabecalho.total_tokens);
+        for (uint64_t i = 0; i < cabecalho.total_diagnosticos; i++)
+            if (diagnosticos[i].offset > chave.tamanho || diagnosticos[i].tamanho > chave.tamanho - diagnosticos[i].offset ||
+                diagnosticos[i].categoria >= total_categorias_erro || diagnosticos[i].antes_do_token >= cabecalho.total_tokens)
+                return false;
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,304 @@
+// Compiladores 2025.1 - Gerador de codigo C-- sintetico
+//
+// Gera programas C-- de tamanho e mistura configuraveis para medir o
+// analisador. A saida depende so da mistura, do tamanho e da semente: a
+// mesma chamada gera sempre os mesmos bytes, em qualquer maquina.
+//
+// Misturas:
+//  - identificadores: nomes longos e variados (muitos distintos), poucos numeros
+//  - comentarios: blocos /* */ grandes, de varias linhas, entre poucos comandos
+//  - numeros: expressoes com muitos inteiros e floats
+//  - erros: codigo valido salpicado com todos os erros lexicos detectados
+//  - misto: declaracoes, atribuicoes, if/else, while e comentarios curtos
+//  - bordas: codigo misto com os casos dificeis do Lexer: UTF-8 valido e
+//    invalido, Latin-1, numeros fora do limite, operadores colados e
+//    comentarios estranhos (termina num comentario sem fechamento)
+
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+enum class Mistura { identificadores, comentarios, numeros, erros, misto, bordas };
+
+constexpr Mistura todas_misturas[] = {
+    Mistura::identificadores, Mistura::comentarios, Mistura::numeros, Mistura::erros, Mistura::misto,
+    Mistura::bordas
+};
+
+inline const char* nome_mistura(Mistura mistura){
+    switch (mistura){
+        case Mistura::identificadores: return "identificadores";
+        case Mistura::comentarios: return "comentarios";
+        case Mistura::numeros: return "numeros";
+        case Mistura::erros: return "erros";
+        case Mistura::bordas: return "bordas";
+        default: return "misto";
+    }
+}
+
+// retorna false se o nome nao for de uma mistura conhecida
+inline bool ler_mistura(std::string_view nome, Mistura& mistura){
+    for (Mistura m : todas_misturas){
+        if (nome == nome_mistura(m)){
+            mistura = m;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Gerador pseudoaleatorio (splitmix64): pequeno e igual em todo compilador,
+// ao contrario das distribuicoes de <random>
+class Sorteio {
+public:
+    explicit Sorteio(uint64_t semente) : estado(semente) {}
+
+    uint64_t proximo(){
+        uint64_t z = (estado += 0x9e3779b97f4a7c15ull);
+        z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+        return z ^ (z >> 31);
+    }
+
+    // inteiro em [0, n)
+    uint32_t ate(uint32_t n){ return (uint32_t)((proximo() >> 32) * n >> 32); }
+
+    template<size_t N>
+    const char* escolher(const char* const (&opcoes)[N]){ return opcoes[ate(N)]; }
+
+private:
+    uint64_t estado;
+};
+
+class GeradorCorpus {
+public:
+    GeradorCorpus(Mistura mistura, uint64_t semente) : mistura(mistura), sorteio(semente) {}
+
+    // acrescenta comandos a 'texto' ate ele ter pelo menos 'tamanho' bytes
+    // (o ultimo comando fica inteiro, entao pode passar um pouco)
+    void gerar(std::string& texto, size_t tamanho){
+        texto.reserve(tamanho + 256);
+        while (texto.size() < tamanho){
+            switch (mistura){
+                case Mistura::identificadores: comando_identificadores(texto); break;
+                case Mistura::comentarios: comando_comentarios(texto); break;
+                case Mistura::numeros: comando_numeros(texto); break;
+                case Mistura::erros: comando_erros(texto); break;
+                case Mistura::bordas: comando_bordas(texto); break;
+                default: comando_misto(texto); break;
+            }
+        }
+        if (mistura == Mistura::bordas) texto += "/* comentario sem fechamento ate o fim\n";
+    }
+
+private:
+    Mistura mistura;
+    Sorteio sorteio;
+    unsigned bloco = 0;
+
+    static constexpr const char* nomes[] = {
+        "contador", "total", "i", "j", "valor_max", "soma", "media", "x", "y",
+        "resultado", "indice", "tmp", "buffer_len", "n"
+    };
+    static constexpr const char* silabas[] = {
+        "ta", "be", "lu", "ro", "mi", "sa", "do", "ca", "ne", "pi", "vo", "xe",
+        "contador", "valor", "indice", "soma", "_", "_", "tmp", "len"
+    };
+    static constexpr const char* palavras[] = {
+        "o", "valor", "de", "cada", "indice", "eh", "somado", "ao", "total", "antes",
+        "do", "laco", "principal", "ver", "nota", "sobre", "limites", "e", "estouro"
+    };
+    static constexpr const char* tipos[] = { "int", "float", "char", "bool" };
+    static constexpr const char* aritmeticos[] = { " + ", " - ", " * ", " / ", " % " };
+    static constexpr const char* relacionais[] = { " < ", " <= ", " > ", " >= ", " == ", " != " };
+
+    void nome(std::string& texto){ texto += sorteio.escolher(nomes); }
+
+    // identificador de 2 a 6 silabas (com digitos de vez em quando)
+    void nome_longo(std::string& texto){
+        texto += "v";
+        for (uint32_t k = 2 + sorteio.ate(5); k > 0; k--) texto += sorteio.escolher(silabas);
+        if (sorteio.ate(4) == 0) texto += std::to_string(sorteio.ate(1000));
+    }
+
+    void inteiro(std::string& texto, uint32_t limite){ texto += std::to_string(sorteio.ate(limite)); }
+
+    void decimal(std::string& texto){
+        inteiro(texto, 100000);
+        texto += '.';
+        inteiro(texto, 100000);
+    }
+
+    void frase(std::string& texto, uint32_t palavras_frase){
+        for (uint32_t k = 0; k < palavras_frase; k++){
+            if (k > 0) texto += ' ';
+            texto += sorteio.escolher(palavras);
+        }
+    }
+
+    void comando_identificadores(std::string& texto){
+        if (sorteio.ate(5) == 0){
+            texto += sorteio.escolher(tipos);
+            texto += ' ';
+            nome_longo(texto);
+            texto += ";\n";
+            return;
+        }
+        nome_longo(texto);
+        texto += " = ";
+        for (uint32_t k = 1 + sorteio.ate(4); k > 0; k--){
+            nome_longo(texto);
+            texto += sorteio.escolher(aritmeticos);
+        }
+        nome_longo(texto);
+        texto += ";\n";
+    }
+
+    void comando_comentarios(std::string& texto){
+        texto += "/* bloco ";
+        texto += std::to_string(bloco++);
+        texto += ":\n";
+        for (uint32_t linhas = 2 + sorteio.ate(10); linhas > 0; linhas--){
+            texto += " * ";
+            frase(texto, 4 + sorteio.ate(10));
+            texto += '\n';
+        }
+        texto += " */\n";
+        nome(texto);
+        texto += " = ";
+        nome(texto);
+        texto += " + 1;\n";
+    }
+
+    void comando_numeros(std::string& texto){
+        nome(texto);
+        texto += " = ";
+        for (uint32_t k = 2 + sorteio.ate(6); k > 0; k--){
+            if (sorteio.ate(2) == 0) inteiro(texto, 1000000000); else decimal(texto);
+            texto += k > 1 ? sorteio.escolher(aritmeticos) : ";\n";
+        }
+    }
+
+    // um comando valido e, em metade das vezes, um erro lexico de cada tipo
+    void comando_erros(std::string& texto){
+        comando_misto(texto);
+        if (sorteio.ate(2) != 0) return;
+        static constexpr const char* erros[] = {
+            "x = 009;\n",           // zeros a esquerda em inteiro
+            "y = 53.;\n",           // parte fracionaria faltando
+            "media = 00.5;\n",      // zeros a esquerda em float
+            "total = total & 1;\n", // '&' sozinho
+            "soma = soma | 2;\n",   // '|' sozinho
+            "n = n @ 3;\n",         // caracteres invalidos
+            "tmp = $tmp # 1;\n",
+            "i = 1 ? j : 2;\n",
+        };
+        texto += sorteio.escolher(erros);
+    }
+
+    // um comando valido e um trecho que costuma separar as implementacoes
+    // do Lexer: caracteres de varios bytes (que caem nas bordas de blocos e
+    // pedacos), valores no limite e lexemas colados
+    void comando_bordas(std::string& texto){
+        comando_misto(texto);
+        static constexpr const char* bordas[] = {
+            "s = \"ação\";\n",                 // UTF-8 valido: um erro por caractere
+            "x = 1 \xe2\x82\xac 2;\n",          // euro, 3 bytes
+            "y = \xf0\x9f\x98\x80;\n",           // emoji, 4 bytes
+            "caf\xe9 = 1;\n",                 // Latin-1
+            "z = \xff\xfe\xc3;\n",             // bytes invalidos e sequencia truncada
+            "w = \xe2\x82 + \xc0\xaf;\n",        // truncada e forma longa
+            "n = 9223372036854775807 + 9223372036854775808;\n",
+            "n = 99999999999999999999999999;\n",
+            "m = 0.000000000000000000000000000001;\n",
+            "k = 007.50 + 0. + 00 + 0.0;\n",
+            "a=b==c!=d<=e>=f&&g||!h;\n",
+            "a &&& b ||| c === d <=> e !!= f;\n",
+            "a = b/ /c /**/ d /***/ e /*/ ainda */ f;\n",
+            "a = 1.2.3 ** / */ ;\n",
+            "\t\r\n  \n\n\t x\t=\t1 ;\n",
+        };
+        texto += sorteio.escolher(bordas);
+        // de vez em quando um trecho longo fora do ASCII, para passar do
+        // limite de erros de codificacao
+        if (sorteio.ate(64) == 0){
+            for (uint32_t k = 1 + sorteio.ate(200); k > 0; k--) texto += "çã\x80";
+            texto += '\n';
+        }
+        // e um float grande demais para um double
+        if (sorteio.ate(32) == 0){
+            texto += "f = ";
+            texto.append(320, '9');
+            texto += ".5;\n";
+        }
+    }
+
+    void comando_misto(std::string& texto){
+        uint32_t t = sorteio.ate(20);
+        if (t < 2){
+            texto += "/* bloco ";
+            texto += std::to_string(bloco++);
+            texto += ": comentario gerado\n   com duas linhas */\n";
+        } else if (t < 6){
+            texto += sorteio.escolher(tipos);
+            texto += ' ';
+            nome(texto);
+            texto += ";\n";
+        } else if (t < 10){
+            nome(texto);
+            texto += " = ";
+            nome(texto);
+            texto += sorteio.escolher(aritmeticos);
+            inteiro(texto, 1000);
+            texto += " * ";
+            nome(texto);
+            texto += ";\n";
+        } else if (t < 13){
+            texto += "if (";
+            nome(texto);
+            texto += sorteio.escolher(relacionais);
+            inteiro(texto, 100);
+            texto += ") {\n   print(";
+            nome(texto);
+            texto += ");\n} else {\n   ";
+            nome(texto);
+            texto += " = ";
+            nome(texto);
+            texto += " - 1;\n}\n";
+        } else if (t < 16){
+            texto += "while (";
+            nome(texto);
+            texto += sorteio.escolher(relacionais);
+            nome(texto);
+            texto += " && ";
+            nome(texto);
+            texto += " > 0 || !";
+            nome(texto);
+            texto += ") {\n   ";
+            nome(texto);
+            texto += "++;\n   readln(";
+            nome(texto);
+            texto += ");\n}\n";
+        } else {
+            texto += "float ";
+            nome(texto);
+            texto += "_f;\n";
+            nome(texto);
+            texto += "_f = ";
+            decimal(texto);
+            texto += ";\n";
+        }
+    }
+};
+
+// Corpus de pelo menos 'tamanho' bytes com a mistura e a semente dadas
+inline std::string gerar_corpus(Mistura mistura, size_t tamanho, uint64_t semente = 1){
+    std::string texto;
+    GeradorCorpus(mistura, semente).gerar(texto, tamanho);
+    return texto;
+}
+
+#endif
@@ -0,0 +1,203 @@
+// Compiladores 2025.1 - Analise encadeada (pipeline)
+//
+// O Lexer roda numa thread propria e entrega os tokens em lotes a thread que
+// os consome (a que formata a saida ou a do Parser), por uma fila circular
+// limitada de um produtor e um consumidor (FilaSPSC). A fila nao tem mutex:
+// cada lado escreve so o seu indice (atomico) e cada indice fica na sua
+// propria linha de cache, junto com a copia que aquele lado guarda do indice
+// do outro, entao os dois nucleos so trocam a linha quando essa copia acaba.
+//
+// Cada posicao da fila eh um LoteTokens inteiro, preenchido no lugar: o
+// custo de sincronizar fica dividido por centenas de tokens. Com a fila cheia
+// o Lexer espera (contrapressao), e a memoria fica limitada a
+// lotes_fila * tokens_lote tokens, qualquer que seja o tamanho da entrada.
+
+#ifndef ENCADEADO_H
+#define ENCADEADO_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>           // unique_ptr
+#include <thread>
+#include <vector>
+
+#include "lexer.h"
+#include "simd.h"           // SIMD_X86 (_mm_pause)
+
+constexpr size_t tamanho_linha_cache = 64;
+
+// espera ativa curta (o outro lado costuma responder em poucas centenas de
+// ciclos) e depois cede o nucleo, para nao girar a toa com um nucleo so
+inline void esperar_vez(unsigned& tentativas){
+    if (++tentativas < 64){
+#ifdef SIMD_X86
+        _mm_pause();
+#endif
+    } else {
+        std::this_thread::yield();
+    }
+}
+
+// Fila circular de um produtor e um consumidor com capacidade fixa (potencia
+// de 2). Os itens sao preenchidos e lidos no lugar:
+//   produtor: T* item = reservar(); ... publicar();
+//   consumidor: T* item = frente(); ... liberar();
+template<class T, size_t capacidade>
+class FilaSPSC {
+    static_assert((capacidade & (capacidade - 1)) == 0, "capacidade da fila deve ser potencia de 2");
+
+public:
+    // produtor: proxima posicao livre, ou nullptr com a fila cheia
+    T* reservar(){
+        size_t posicao = cauda.load(std::memory_order_relaxed);
+        if (posicao - cabeca_vista == capacidade){
+            cabeca_vista = cabeca.load(std::memory_order_acquire);
+            if (posicao - cabeca_vista == capacidade) return nullptr;
+        }
+        return &itens[posicao & (capacidade - 1)];
+    }
+
+    // produtor: entrega o item reservado
+    void publicar(){
+        cauda.store(cauda.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // consumidor: item mais antigo, ou nullptr com a fila vazia
+    T* frente(){
+        size_t posicao = cabeca.load(std::memory_order_relaxed);
+        if (posicao == cauda_vista){
+            cauda_vista = cauda.load(std::memory_order_acquire);
+            if (posicao == cauda_vista) return nullptr;
+        }
+        return &itens[posicao & (capacidade - 1)];
+    }
+
+    // consumidor: devolve a posicao do item lido ao produtor
+    void liberar(){
+        cabeca.store(cabeca.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+private:
+    // lado do consumidor
+    alignas(tamanho_linha_cache) std::atomic<size_t> cabeca{0};
+    size_t cauda_vista = 0;
+    // lado do produtor
+    alignas(tamanho_linha_cache) std::atomic<size_t> cauda{0};
+    size_t cabeca_vista = 0;
+
+    alignas(tamanho_linha_cache) T itens[capacidade];
+};
+
+// Tokens de um trecho da entrada; diagnosticos[i] vem antes de
+// tokens[antes_do_token[i]] (como em PedacoLexico)
+struct LoteTokens {
+    static constexpr size_t capacidade = 512;
+
+    Token tokens[capacidade];
+    size_t total = 0;
+    std::vector<Diagnostico> diagnosticos;      // a capacidade fica de um uso para o outro
+    std::vector<uint32_t> antes_do_token;
+};
+
+// Fonte de tokens com a mesma interface do Lexer (proximo(), diagnosticos e
+// simbolos), mas com o Lexer numa thread separada. A thread so comeca na
+// primeira chamada a proximo(), entao 'simbolos' pode ser definida antes
+// (o Parser faz isso no construtor); os IDs sao internados pela thread do
+// Lexer e a tabela so pode ser lida depois do EOF.
+class TokensEncadeados {
+public:
+    static constexpr size_t lotes_fila = 16;
+
+    std::vector<Diagnostico> diagnosticos;  // erros encontrados ate o ultimo token entregue
+    TabelaSimbolos* simbolos = nullptr;
+
+    TokensEncadeados(const char* inicio, const char* fim)
+        : lexer(inicio, fim), fila(std::make_unique<FilaSPSC<LoteTokens, lotes_fila>>()) {}
+
+    TokensEncadeados(const TokensEncadeados&) = delete;
+    TokensEncadeados& operator=(const TokensEncadeados&) = delete;
+
+    // abandonado antes do EOF: o Lexer para no proximo lote
+    ~TokensEncadeados(){
+        cancelado.store(true, std::memory_order_relaxed);
+        if (produtor.joinable()) produtor.join();
+    }
+
+    Token proximo(){
+        if (terminou) return eof;
+        if (lote == nullptr || indice == lote->total) proximo_lote();
+
+        while (proximo_erro < lote->diagnosticos.size() && lote->antes_do_token[proximo_erro] == indice)
+            diagnosticos.push_back(lote->diagnosticos[proximo_erro++]);
+        Token token = lote->tokens[indice++];
+
+        // o EOF eh o ultimo token do ultimo lote: a thread do Lexer ja acabou
+        if (token.tipo == tk_eof){
+            eof = token;
+            terminou = true;
+            fila->liberar();
+            lote = nullptr;
+            produtor.join();
+        }
+        return token;
+    }
+
+private:
+    Lexer lexer;                    // usado so pela thread produtora
+    std::unique_ptr<FilaSPSC<LoteTokens, lotes_fila>> fila;
+    std::thread produtor;
+    std::atomic<bool> cancelado{false};
+
+    // lado do consumidor
+    LoteTokens* lote = nullptr;     // lote sendo lido
+    size_t indice = 0;              // proximo token do lote
+    size_t proximo_erro = 0;        // proximo diagnostico do lote
+    bool terminou = false;
+    Token eof{};
+
+    void proximo_lote(){
+        if (lote != nullptr) fila->liberar();
+        else if (!produtor.joinable()){
+            lexer.simbolos = simbolos;
+            produtor = std::thread(&TokensEncadeados::produzir, this);
+        }
+        unsigned tentativas = 0;
+        while ((lote = fila->frente()) == nullptr) esperar_vez(tentativas);
+        indice = 0;
+        proximo_erro = 0;
+    }
+
+    void produzir(){
+        while (true){
+            LoteTokens* destino;
+            unsigned tentativas = 0;
+            while ((destino = fila->reservar()) == nullptr){
+                if (cancelado.load(std::memory_order_relaxed)) return;
+                esperar_vez(tentativas);
+            }
+
+            destino->total = 0;
+            destino->diagnosticos.clear();
+            destino->antes_do_token.clear();
+            bool fim = false;
+            while (destino->total < LoteTokens::capacidade){
+                Token token = lexer.proximo();
+                for (const Diagnostico& erro : lexer.diagnosticos){
+                    destino->diagnosticos.push_back(erro);
+                    destino->antes_do_token.push_back((uint32_t)destino->total);
+                }
+                lexer.diagnosticos.clear();
+                destino->tokens[destino->total++] = token;
+                if (token.tipo == tk_eof){
+                    fim = true;
+                    break;
+                }
+            }
+            fila->publicar();
+            if (fim || cancelado.load(std::memory_order_relaxed)) return;
+        }
+    }
+};
+
+#endif
@@ -0,0 +1,134 @@
+// Compiladores 2025.1 - Entrada do Analisador Lexico
+//
+// Carrega o arquivo fonte em um unico bloco contiguo de memoria, para que o
+// analisador percorra os caracteres por ponteiro (sem get/unget de stream).
+
+#ifndef ENTRADA_H
+#define ENTRADA_H
+
+#include <string>       // buffer quando o mapeamento nao eh possivel
+#include <vector>       // lista de arquivos
+#include <istream>      // leitura de entradas nao buscaveis
+#include <fstream>      // lista de arquivos (@lista)
+#include <iterator>     // istreambuf_iterator
+#include <algorithm>    // min
+
+#ifdef _WIN32
+#define NOMINMAX        // evita as macros min/max do windows.h
+#include <windows.h>    // mapeamento de arquivos (CreateFileMapping, MapViewOfFile)
+#else
+#include <sys/mman.h>   // mapeamento de arquivos em memoria (mmap)
+#include <sys/stat.h>   // tamanho e tipo do arquivo (fstat)
+#include <fcntl.h>      // abertura de arquivos (open)
+#include <unistd.h>     // leitura e fechamento (read, close)
+#endif
+
+// Arquivo de entrada carregado em um unico bloco contiguo de memoria
+// (mapeado com mmap quando possivel, ou lido inteiro para o buffer)
+struct ArquivoMapeado {
+    const char* dados = nullptr;
+    size_t tamanho = 0;
+    bool mapeado = false;   // true quando dados aponta para um mapeamento (mmap)
+    std::string buffer;     // usado quando o mapeamento nao eh possivel
+
+    ArquivoMapeado() = default;
+    ArquivoMapeado(const ArquivoMapeado&) = delete;     // o mapeamento tem um unico dono
+    ArquivoMapeado& operator=(const ArquivoMapeado&) = delete;
+
+    ~ArquivoMapeado(){
+        if (!mapeado) return;
+#ifdef _WIN32
+        UnmapViewOfFile(dados);
+#else
+        munmap((void*)dados, tamanho);
+#endif
+    }
+};
+
+// Carrega o arquivo em memoria para a analise por ponteiros
+// retorna false se a entrada nao for um arquivo comum (pipe, fifo, terminal),
+// caso em que o chamador deve usar a leitura por ifstream
+inline bool mapear_arquivo(const char* caminho, ArquivoMapeado& arquivo){
+#ifdef _WIN32
+    HANDLE h = CreateFileA(caminho, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (h == INVALID_HANDLE_VALUE || GetFileType(h) != FILE_TYPE_DISK){
+        if (h != INVALID_HANDLE_VALUE) CloseHandle(h);
+        return false;
+    }
+    LARGE_INTEGER tamanho;
+    GetFileSizeEx(h, &tamanho);
+    arquivo.tamanho = (size_t)tamanho.QuadPart;
+    if (arquivo.tamanho > 0){
+        HANDLE mapa = CreateFileMappingA(h, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapa != NULL){
+            arquivo.dados = (const char*)MapViewOfFile(mapa, FILE_MAP_READ, 0, 0, 0);
+            CloseHandle(mapa);
+            arquivo.mapeado = (arquivo.dados != NULL);
+        }
+        if (!arquivo.mapeado){
+            // sem mapeamento: le o arquivo inteiro para o buffer
+            arquivo.buffer.resize(arquivo.tamanho);
+            DWORD lidos = 0;
+            size_t total = 0;
+            while (total < arquivo.tamanho && ReadFile(h, &arquivo.buffer[total], (DWORD)std::min<size_t>(arquivo.tamanho - total, 1u << 30), &lidos, NULL) && lidos > 0)
+                total += lidos;
+            arquivo.buffer.resize(total);
+            arquivo.dados = arquivo.buffer.data();
+            arquivo.tamanho = total;
+        }
+    }
+    CloseHandle(h);
+    return true;
+#else
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat info;
+    if (fstat(fd, &info) != 0 || !S_ISREG(info.st_mode)){
+        close(fd);
+        return false;
+    }
+
+    arquivo.tamanho = (size_t)info.st_size;
+    if (arquivo.tamanho > 0){
+        void* mapa = mmap(NULL, arquivo.tamanho, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa != MAP_FAILED){
+            madvise(mapa, arquivo.tamanho, MADV_SEQUENTIAL); // leitura sequencial: o kernel pode adiantar paginas
+            arquivo.dados = (const char*)mapa;
+            arquivo.mapeado = true;
+        } else {
+            // sem mapeamento: le o arquivo inteiro para o buffer
+            arquivo.buffer.resize(arquivo.tamanho);
+            size_t total = 0;
+            ssize_t lidos;
+            while (total < arquivo.tamanho && (lidos = read(fd, &arquivo.buffer[total], arquivo.tamanho - total)) > 0)
+                total += (size_t)lidos;
+            arquivo.buffer.resize(total);
+            arquivo.dados = arquivo.buffer.data();
+            arquivo.tamanho = total;
+        }
+    }
+    close(fd);
+    return true;
+#endif
+}
+
+// Le todo o conteudo de uma entrada nao buscavel (pipe, fifo, ...) para a memoria
+inline std::string ler_fluxo(std::istream& fluxo){
+    return std::string((std::istreambuf_iterator<char>(fluxo)), std::istreambuf_iterator<char>());
+}
+
+// Le uma lista de arquivos (argumento @lista na linha de comando): um caminho
+// por linha, ignorando linhas vazias. Retorna false se a lista nao abrir
+inline bool ler_lista_arquivos(const char* caminho, std::vector<std::string>& arquivos){
+    std::ifstream lista(caminho);
+    if (!lista.is_open()) return false;
+    std::string linha;
+    while (std::getline(lista, linha)){
+        if (!linha.empty() && linha.back() == '\r') linha.pop_back();   // listas geradas no windows
+        if (!linha.empty()) arquivos.push_back(linha);
+    }
+    return true;
+}
+
+#endif
@@ -0,0 +1,96 @@
+// Compiladores 2025.1 - Analise de fluxos (stdin, pipes, fifos)
+//
+// Entradas que nao podem ser mapeadas em memoria sao lidas em blocos para
+// um buffer de tamanho fixo, reaproveitado do inicio a cada bloco. O Lexer
+// recebe cada bloco com continuar(): ao chegar no fim do bloco ele para sem
+// emitir o lexema que ainda pode continuar, esse resto eh copiado para o
+// inicio do buffer e o proximo bloco eh lido logo depois dele. Comentarios
+// que atravessam blocos nao sao guardados, so pulados.
+//
+// A memoria fica limitada ao buffer (ele so cresce se um unico lexema for
+// maior que metade dele), qualquer que seja o tamanho da entrada. O indice
+// de linhas tambem cobre so o bloco atual: antes de o buffer ser
+// reaproveitado, as quebras do trecho ja analisado viram uma contagem.
+
+#ifndef FLUXO_H
+#define FLUXO_H
+
+#include <cstring>      // memmove
+#include <istream>
+#include <memory>       // unique_ptr
+
+#include "lexer.h"
+#include "linhas.h"
+#include "perfil.h"
+#include "saida.h"
+
+constexpr size_t tamanho_bloco_fluxo = 1 << 20;
+
+// le ate 'tamanho' bytes (menos so no fim da entrada)
+inline size_t ler_bloco(std::istream& entrada, char* destino, size_t tamanho){
+    entrada.read(destino, (std::streamsize)tamanho);
+    return (size_t)entrada.gcount();
+}
+
+// Entrega os tokens e erros a saida ate o EOF (retorna false) ou ate o
+// Lexer parar no fim do bloco esperando o proximo (retorna true)
+inline bool analisar_bloco(Lexer& lexer, Saida& saida){
+    while (true){
+        Token token = lexer.proximo();
+
+        for (const Diagnostico& erro : lexer.diagnosticos)
+            saida.diagnostico(erro);
+        lexer.diagnosticos.clear();
+
+        if (token.tipo == tk_eof && lexer.aguardando_dados()) return true;
+        saida.token(token);
+        if (token.tipo == tk_eof) return false;
+    }
+}
+
+// Analisa a entrada inteira em blocos, entregando os tokens e erros a saida
+// na mesma ordem da analise de um bloco contiguo (com os IDs internados em
+// 'simbolos', se houver). Com 'perfil' a leitura dos blocos conta como tempo
+// de entrada e cada bloco passa pelo Perfilador
+inline void analisar_fluxo(std::istream& entrada, Saida& saida, TabelaSimbolos* simbolos = nullptr,
+                           size_t capacidade = tamanho_bloco_fluxo, Perfilador* perfil = nullptr){
+    double inicio_leitura = perfil ? relogio() : 0;
+    std::unique_ptr<char[]> buffer(new char[capacidade]);
+    size_t cheio = ler_bloco(entrada, buffer.get(), capacidade);
+    bool ultimo = cheio < capacidade;
+    if (perfil) perfil->tempo_entrada += relogio() - inicio_leitura;
+
+    Lexer lexer(buffer.get(), buffer.get());
+    lexer.simbolos = simbolos;
+    lexer.continuar(buffer.get(), buffer.get() + cheio, ultimo);
+    IndiceLinhas linhas;
+    linhas.mudar_janela(buffer.get(), buffer.get() + cheio);
+    saida.usar_linhas(&linhas);
+
+    while (perfil ? perfil->analisar(lexer, saida) : analisar_bloco(lexer, saida)){
+        if (perfil) inicio_leitura = relogio();
+
+        // leva o lexema incompleto para o inicio do buffer e completa com
+        // o proximo bloco (dobrando o buffer se o lexema ocupa mais da metade)
+        size_t resto = (size_t)(buffer.get() + cheio - lexer.pendente());
+        linhas.descartar_ate(lexer.pendente());
+        if (resto > capacidade / 2){
+            std::unique_ptr<char[]> maior(new char[capacidade * 2]);
+            memcpy(maior.get(), lexer.pendente(), resto);
+            buffer = std::move(maior);
+            capacidade *= 2;
+        } else {
+            memmove(buffer.get(), lexer.pendente(), resto);
+        }
+        size_t lidos = ler_bloco(entrada, buffer.get() + resto, capacidade - resto);
+        ultimo = lidos < capacidade - resto;
+        cheio = resto + lidos;
+        lexer.continuar(buffer.get(), buffer.get() + cheio, ultimo);
+        linhas.mudar_janela(buffer.get(), buffer.get() + cheio);
+
+        if (perfil) perfil->tempo_entrada += relogio() - inicio_leitura;
+    }
+    saida.usar_linhas(nullptr);
+}
+
+#endif
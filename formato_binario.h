@@ -0,0 +1,205 @@
+// Compiladores 2025.1 - Formato binario de tokens
+//
+// Saida compacta do analisador (opcao --format=bin), para que as proximas
+// etapas leiam os tokens sem precisar analisar o texto de novo.
+//
+// Layout (inteiros em varint: 7 bits por byte, bit alto = continua):
+//
+//   cabecalho: 'C' '-' '-' 'T' | versao (1 byte) | flags (1 byte)
+//   registros, ate o token tk_eof:
+//     token:       tipo (1 byte, < 0x80)
+//                  [indice do lexema]          so para ID e numeros
+//                  [delta offset]              se flags & com_posicoes
+//     diagnostico: 0x80 | categoria (1 byte)
+//                  indice do lexema, offset
+//
+// Desde a versao 2 as posicoes sao so offsets, como nos tokens do Lexer: a
+// linha e a coluna saem de um IndiceLinhas (linhas.h) sobre o texto fonte.
+//
+// Os lexemas ficam numa tabela de strings internadas: o indice igual ao
+// tamanho atual da tabela define uma string nova, seguida do tamanho e dos
+// bytes; os demais indices reusam uma string ja vista. Assim cada
+// identificador aparece por extenso uma unica vez no arquivo.
+
+#ifndef FORMATO_BINARIO_H
+#define FORMATO_BINARIO_H
+
+#include <cstdint>
+#include <cstring>          // memcmp
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer.h"          // Token, Diagnostico
+#include "simbolos.h"       // internacao dos lexemas na escrita
+
+constexpr char assinatura_binaria[4] = {'C', '-', '-', 'T'};
+constexpr uint8_t versao_binaria = 2;
+
+enum flags_binario : uint8_t {
+    com_posicoes = 1 << 0,  // cada token traz o seu offset
+};
+
+constexpr uint8_t marca_diagnostico = 0x80;
+
+// tokens cujo lexema varia e por isso vai para a tabela de strings
+inline bool tem_lexema_variavel(tipos_token tipo){
+    return tipo == tk_id || tipo == tk_num_int || tipo == tk_num_float;
+}
+
+// Escreve tokens e diagnosticos no formato binario, acrescentando os bytes
+// ao final de 'destino' (quem possui o destino decide quando grava-lo).
+// Os lexemas internados sao copiados para a arena da tabela de strings,
+// porque a entrada pode chegar em partes que reaproveitam o mesmo buffer (fluxo.h)
+class EscritorBinario {
+public:
+    EscritorBinario(std::string& destino, uint8_t flags = 0)
+        : buffer(destino), flags(flags) {
+        buffer.append(assinatura_binaria, 4);
+        buffer.push_back((char)versao_binaria);
+        buffer.push_back((char)flags);
+    }
+
+    void escrever(const Token& token){
+        buffer.push_back((char)token.tipo);
+        if (tem_lexema_variavel(token.tipo))
+            escrever_lexema(token.lexema);
+        if (flags & com_posicoes){
+            escrever_varint(token.offset - offset_anterior);
+            offset_anterior = token.offset;
+        }
+    }
+
+    void escrever(const Diagnostico& erro){
+        buffer.push_back((char)(marca_diagnostico | erro.categoria));
+        escrever_lexema(erro.lexema);
+        escrever_varint(erro.offset);
+    }
+
+private:
+    std::string& buffer;
+    uint8_t flags;
+    TabelaSimbolos strings;     // lexema -> indice na tabela de strings
+    size_t offset_anterior = 0;
+
+    void escrever_varint(uint64_t valor){
+        while (valor >= 0x80){
+            buffer.push_back((char)(valor | 0x80));
+            valor >>= 7;
+        }
+        buffer.push_back((char)valor);
+    }
+
+    void escrever_lexema(std::string_view lexema){
+        size_t conhecidas = strings.tamanho();
+        uint32_t indice = strings.internar(lexema);
+        escrever_varint(indice);
+        if (indice == conhecidas){
+            escrever_varint(lexema.size());
+            buffer.append(lexema.data(), lexema.size());
+        }
+    }
+};
+
+// Le o formato binario de volta como um fluxo de tokens, com a mesma
+// interface do Lexer: proximo() ate tk_eof e os erros em diagnosticos.
+// Os lexemas apontam para o proprio buffer lido (que pode ser um arquivo
+// mapeado com mapear_arquivo), sem copias
+class LeitorBinario {
+public:
+    std::vector<Diagnostico> diagnosticos;
+
+    // valida o cabecalho; retorna false se nao for um fluxo desta versao
+    bool abrir(const char* dados, size_t tamanho){
+        p = (const uint8_t*)dados;
+        fim = p + tamanho;
+        if (tamanho < 6 || memcmp(dados, assinatura_binaria, 4) != 0 || p[4] != versao_binaria)
+            return false;
+        flags = p[5];
+        p += 6;
+        return true;
+    }
+
+    // devolve o proximo token; um fluxo truncado ou corrompido termina em tk_eof
+    // e marca corrompido = true
+    Token proximo(){
+        while (p < fim){
+            uint8_t marca = *p++;
+            if (marca & marca_diagnostico){
+                Diagnostico erro;
+                erro.categoria = (categorias_erro)(marca & ~marca_diagnostico);
+                erro.lexema = ler_lexema();
+                erro.offset = ler_varint();
+                if (corrompido || erro.categoria >= total_categorias_erro){
+                    corrompido = true;
+                    break;
+                }
+                diagnosticos.push_back(erro);
+                continue;
+            }
+
+            Token token{(tipos_token)marca, {}, 0};
+            if (token.tipo >= total_tokens){
+                corrompido = true;
+                break;
+            }
+            if (tem_lexema_variavel(token.tipo))
+                token.lexema = ler_lexema();
+            if (flags & com_posicoes){
+                offset += ler_varint();
+                token.offset = offset;
+            }
+            if (corrompido) break;
+            if (token.tipo == tk_eof){
+                terminou = true;
+                p = fim;
+            }
+            return token;
+        }
+        // um fluxo valido sempre termina no proprio token tk_eof
+        if (!terminou) corrompido = true;
+        terminou = true;
+        p = fim;
+        return {tk_eof, {}, offset};
+    }
+
+    bool corrompido = false;    // fluxo truncado ou com registro invalido
+
+private:
+    const uint8_t* p = nullptr;
+    const uint8_t* fim = nullptr;
+    uint8_t flags = 0;
+    bool terminou = false;
+    std::vector<std::string_view> strings;
+    size_t offset = 0;
+
+    uint64_t ler_varint(){
+        uint64_t valor = 0;
+        for (int deslocamento = 0; p < fim && deslocamento < 64; deslocamento += 7){
+            uint8_t byte = *p++;
+            valor |= (uint64_t)(byte & 0x7f) << deslocamento;
+            if (!(byte & 0x80)) return valor;
+        }
+        corrompido = true;
+        return 0;
+    }
+
+    std::string_view ler_lexema(){
+        uint64_t indice = ler_varint();
+        if (indice < strings.size()) return strings[indice];
+        if (indice > strings.size()){
+            corrompido = true;
+            return {};
+        }
+        uint64_t tamanho = ler_varint();
+        if (corrompido || tamanho > (uint64_t)(fim - p)){
+            corrompido = true;
+            return {};
+        }
+        strings.emplace_back((const char*)p, tamanho);
+        p += tamanho;
+        return strings.back();
+    }
+};
+
+#endif
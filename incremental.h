@@ -0,0 +1,301 @@
+// Compiladores 2025.1 - Reanalise incremental
+//
+// Para editores: um DocumentoLexico guarda o texto e os seus tokens, e a
+// cada edicao (offset, bytes removidos, texto inserido) analisa de novo so
+// o trecho afetado:
+//
+//  - recomeca no inicio do ultimo token que termina antes da edicao (a
+//    analise de um token olha um byte a frente, entao um token colado na
+//    edicao pode mudar: "a" + "b" vira "ab", "<" + "=" vira "<=");
+//  - segue ate passar do fim da edicao e emitir um token que comeca
+//    exatamente onde comecava um token antigo (deslocado pela edicao). Um
+//    token so comeca fora de comentario e com o automato no estado inicial,
+//    e os bytes dali em diante sao os mesmos, entao o resto da sequencia
+//    antiga continua valido, inclusive quando a edicao abre ou fecha um
+//    /* comentario */ (nesse caso a reanalise vai ate onde ele fechar);
+//  - emenda os tokens novos no lugar dos antigos. Os seguintes so mudam de
+//    offset, todos pelo mesmo tanto.
+//
+// Os tokens ficam em blocos de ate 512, cada um com um deslocamento de
+// offset ainda nao aplicado aos seus itens: uma edicao refaz so
+// os blocos que tocou e soma o deslocamento nos blocos seguintes, entao o
+// custo depende do tamanho da edicao (e do numero de blocos), nao do numero
+// de tokens. Os lexemas sao montados ao ler, a partir do offset, e a linha e
+// a coluna vem de um indice de linhas (linhas.h) refeito so quando alguem
+// pergunta uma posicao depois de uma edicao.
+
+#ifndef INCREMENTAL_H
+#define INCREMENTAL_H
+
+#include <algorithm>    // partition_point
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer.h"
+#include "linhas.h"
+
+// Troca de 'removidos' bytes a partir de 'offset' por 'inseridos'
+struct Edicao {
+    size_t offset;
+    size_t removidos;
+    std::string_view inseridos;
+};
+
+// Sequencia de itens com offset e lexema (Token ou Diagnostico), ordenada
+// por offset e guardada em blocos com deslocamento pendente
+template <typename T>
+class SequenciaEmBlocos {
+public:
+    static constexpr size_t tamanho_bloco = 512;
+
+    struct Posicao {
+        size_t bloco;
+        size_t indice;
+    };
+
+    size_t tamanho() const { return total; }
+    Posicao fim() const { return {blocos.size(), 0}; }
+    bool no_fim(Posicao posicao) const { return posicao.bloco >= blocos.size(); }
+
+    // item com o deslocamento aplicado e o lexema apontando para 'texto'
+    // (sem texto, so o tamanho do lexema vale)
+    T item(Posicao posicao, const char* texto = nullptr) const {
+        const Bloco& bloco = blocos[posicao.bloco];
+        T item = bloco.itens[posicao.indice];
+        item.offset += (size_t)bloco.delta_offset;
+        if (texto != nullptr) item.lexema = std::string_view(texto + item.offset, item.lexema.size());
+        return item;
+    }
+
+    void avancar(Posicao& posicao) const {
+        if (++posicao.indice == blocos[posicao.bloco].itens.size()){
+            posicao.bloco++;
+            posicao.indice = 0;
+        }
+    }
+
+    void recuar(Posicao& posicao) const {
+        if (posicao.indice > 0){
+            posicao.indice--;
+        } else {
+            posicao.bloco--;
+            posicao.indice = blocos[posicao.bloco].itens.size() - 1;
+        }
+    }
+
+    // primeira posicao cujo item nao satisfaz 'antes' (que vale para um
+    // prefixo da sequencia), por busca binaria nos blocos e dentro do bloco
+    template <typename Predicado>
+    Posicao particao(Predicado antes) const {
+        size_t b = (size_t)(std::partition_point(blocos.begin(), blocos.end(), [&](const Bloco& bloco){
+            return antes(item({(size_t)(&bloco - blocos.data()), bloco.itens.size() - 1}));
+        }) - blocos.begin());
+        if (b == blocos.size()) return fim();
+        size_t i = 0, n = blocos[b].itens.size();
+        while (i < n){
+            size_t meio = (i + n) / 2;
+            if (antes(item({b, meio}))) i = meio + 1;
+            else n = meio;
+        }
+        return {b, i};
+    }
+
+    // troca os itens [de, ate) pelos novos (ja nas posicoes finais) e desloca
+    // os itens a partir de 'ate'
+    void substituir(Posicao de, Posicao ate, const std::vector<T>& novos, ptrdiff_t delta_offset){
+        size_t primeiro_bloco = std::min(de.bloco, blocos.size());
+        size_t fim_blocos = ate.bloco;
+        std::vector<T> trecho;
+
+        if (primeiro_bloco < blocos.size()){
+            normalizar(blocos[primeiro_bloco]);
+            const std::vector<T>& itens = blocos[primeiro_bloco].itens;
+            trecho.assign(itens.begin(), itens.begin() + de.indice);
+        }
+        trecho.insert(trecho.end(), novos.begin(), novos.end());
+        if (fim_blocos < blocos.size()){
+            normalizar(blocos[fim_blocos]);
+            const std::vector<T>& itens = blocos[fim_blocos].itens;
+            for (size_t i = ate.indice; i < itens.size(); i++){
+                T item = itens[i];
+                item.offset += (size_t)delta_offset;
+                trecho.push_back(item);
+            }
+            fim_blocos++;
+        }
+
+        // blocos seguintes: so o deslocamento pendente
+        for (size_t b = fim_blocos; b < blocos.size(); b++) blocos[b].delta_offset += delta_offset;
+
+        // um trecho pequeno absorve o bloco seguinte, para os blocos nao se fragmentarem
+        if (trecho.size() < tamanho_bloco / 2 && fim_blocos < blocos.size()){
+            normalizar(blocos[fim_blocos]);
+            trecho.insert(trecho.end(), blocos[fim_blocos].itens.begin(), blocos[fim_blocos].itens.end());
+            fim_blocos++;
+        }
+
+        for (size_t b = primeiro_bloco; b < fim_blocos; b++) total -= blocos[b].itens.size();
+        total += trecho.size();
+
+        std::vector<Bloco> divididos;
+        for (size_t i = 0; i < trecho.size(); i += tamanho_bloco){
+            Bloco bloco;
+            bloco.itens.assign(trecho.begin() + i, trecho.begin() + std::min(trecho.size(), i + tamanho_bloco));
+            divididos.push_back(std::move(bloco));
+        }
+        blocos.erase(blocos.begin() + primeiro_bloco, blocos.begin() + fim_blocos);
+        blocos.insert(blocos.begin() + primeiro_bloco,
+                      std::make_move_iterator(divididos.begin()), std::make_move_iterator(divididos.end()));
+    }
+
+    // todos os itens a partir de 'posicao' ate 'parar' devolver true
+    template <typename Funcao>
+    void percorrer(Posicao posicao, const char* texto, Funcao parar) const {
+        for (; !no_fim(posicao); avancar(posicao))
+            if (parar(item(posicao, texto))) return;
+    }
+
+private:
+    struct Bloco {
+        std::vector<T> itens;
+        ptrdiff_t delta_offset = 0;     // ainda nao somado aos itens
+    };
+
+    std::vector<Bloco> blocos;      // nenhum bloco vazio
+    size_t total = 0;
+
+    static void normalizar(Bloco& bloco){
+        if (bloco.delta_offset == 0) return;
+        for (T& item : bloco.itens) item.offset += (size_t)bloco.delta_offset;
+        bloco.delta_offset = 0;
+    }
+};
+
+class DocumentoLexico {
+public:
+    // analisa o texto inteiro; com 'simbolos' os IDs recebem o id do nome
+    explicit DocumentoLexico(std::string texto_inicial, TabelaSimbolos* simbolos = nullptr)
+        : texto_(std::move(texto_inicial)), simbolos(simbolos) {
+        sincronizar(0, tokens_.fim(), {texto_.size(), 0, {}});
+    }
+
+    const std::string& texto() const { return texto_; }
+    size_t total_tokens() const { return tokens_.tamanho(); }
+
+    // todos os tokens (terminando no tk_eof) e erros, com os lexemas no texto atual
+    std::vector<Token> tokens() const { return tokens_entre(0, (size_t)-1); }
+    std::vector<Diagnostico> diagnosticos() const {
+        std::vector<Diagnostico> erros;
+        diagnosticos_.percorrer({0, 0}, texto_.data(), [&](const Diagnostico& erro){ erros.push_back(erro); return false; });
+        return erros;
+    }
+
+    // tokens que terminam depois de 'inicio' e comecam antes de 'fim' (o
+    // trecho que o editor precisa redesenhar)
+    std::vector<Token> tokens_entre(size_t inicio, size_t fim) const {
+        std::vector<Token> trecho;
+        auto termina_antes = [&](const Token& token){ return token.offset + token.lexema.size() <= inicio && token.tipo != tk_eof; };
+        tokens_.percorrer(tokens_.particao(termina_antes), texto_.data(), [&](const Token& token){
+            if (token.offset >= fim) return true;
+            trecho.push_back(token);
+            return false;
+        });
+        return trecho;
+    }
+
+    // linha e coluna de um offset do texto atual
+    PosicaoTexto posicao(size_t offset) const {
+        if (!linhas_em_dia){
+            linhas = IndiceLinhas(texto_.data(), texto_.data() + texto_.size());
+            linhas_em_dia = true;
+        }
+        return linhas.posicao(offset);
+    }
+
+    // tokens produzidos pelo analisador na ultima edicao (o custo dela)
+    size_t tokens_reanalisados() const { return reanalisados; }
+
+    // aplica a edicao ao texto e atualiza tokens e diagnosticos
+    void editar(const Edicao& edicao){
+        // ultimo token que termina antes da edicao (sem contar o byte a frente)
+        auto termina_antes = [&](const Token& token){ return token.offset + token.lexema.size() < edicao.offset; };
+        Posicao primeiro = tokens_.particao(termina_antes);
+
+        size_t reinicio = 0;
+        if (primeiro.bloco > 0 || primeiro.indice > 0){
+            tokens_.recuar(primeiro);
+            reinicio = tokens_.item(primeiro).offset;
+        }
+
+        texto_.replace(edicao.offset, edicao.removidos, edicao.inseridos.data(), edicao.inseridos.size());
+        linhas_em_dia = false;
+        sincronizar(reinicio, primeiro, edicao);
+    }
+
+private:
+    using Posicao = SequenciaEmBlocos<Token>::Posicao;
+
+    std::string texto_;
+    SequenciaEmBlocos<Token> tokens_;
+    SequenciaEmBlocos<Diagnostico> diagnosticos_;
+    TabelaSimbolos* simbolos;
+    size_t reanalisados = 0;
+    mutable IndiceLinhas linhas;        // do texto atual, se linhas_em_dia
+    mutable bool linhas_em_dia = false;
+
+    // reanalisa a partir do token 'primeiro' (que comeca em 'reinicio') ate
+    // reencontrar a sequencia antiga, e emenda o resultado
+    void sincronizar(size_t reinicio, Posicao primeiro, const Edicao& edicao){
+        const size_t fim_edicao = edicao.offset + edicao.inseridos.size();     // no texto novo
+        const size_t removidos = edicao.removidos, inseridos = edicao.inseridos.size();
+
+        Lexer lexer(texto_.data(), texto_.data() + reinicio, texto_.data() + texto_.size());
+        lexer.simbolos = simbolos;
+        // sem limite de erros fora do ASCII: a contagem dependeria de onde a
+        // reanalise comeca, e o editor quer cada erro junto do seu trecho
+        lexer.limite_erros_codificacao = (size_t)-1;
+
+        std::vector<Token> novos;
+        std::vector<Diagnostico> novos_erros;
+        Posicao antigo = primeiro;          // candidato a ponto de sincronizacao
+        bool sincronizou = false;
+
+        while (true){
+            Token token = lexer.proximo();
+            for (const Diagnostico& erro : lexer.diagnosticos) novos_erros.push_back(erro);
+            lexer.diagnosticos.clear();
+
+            if (token.tipo != tk_eof && token.offset >= fim_edicao){
+                // offsets antigos de 'antigo' comparados ao offset antigo do
+                // token (token.offset - inseridos + removidos)
+                while (!tokens_.no_fim(antigo) && tokens_.item(antigo).offset + inseridos < token.offset + removidos)
+                    tokens_.avancar(antigo);
+                if (!tokens_.no_fim(antigo) && tokens_.item(antigo).offset + inseridos == token.offset + removidos){
+                    // os erros deste token ja estao na sequencia antiga
+                    while (!novos_erros.empty() && novos_erros.back().offset >= token.offset) novos_erros.pop_back();
+                    sincronizou = true;
+                    break;
+                }
+            }
+            novos.push_back(token);
+            if (token.tipo == tk_eof) break;
+        }
+        reanalisados = novos.size() + (sincronizou ? 1 : 0);
+        if (!sincronizou) antigo = tokens_.fim();
+
+        // a cauda antiga (a partir do token de sincronia) so muda de offset
+        ptrdiff_t delta_offset = (ptrdiff_t)inseridos - (ptrdiff_t)removidos;
+        size_t offset_cauda = sincronizou ? tokens_.item(antigo).offset : (size_t)-1;
+
+        // erros antigos: os de antes do reinicio ficam, os do trecho refeito
+        // saem e os da cauda sao deslocados junto com os tokens
+        auto antes_de = [](size_t limite){ return [limite](const Diagnostico& erro){ return erro.offset < limite; }; };
+        auto inicio_refeito = diagnosticos_.particao(antes_de(reinicio));
+        auto inicio_cauda = diagnosticos_.particao(antes_de(offset_cauda));
+        diagnosticos_.substituir(inicio_refeito, inicio_cauda, novos_erros, delta_offset);
+        tokens_.substituir(primeiro, antigo, novos, delta_offset);
+    }
+};
+
+#endif
@@ -0,0 +1,363 @@
+// Compiladores 2025.1 - Analisador Lexico (biblioteca)
+//
+// Interface "puxada" do analisador: cada chamada a Lexer::proximo() devolve
+// o proximo token da entrada. O lexema de cada token eh um string_view que
+// aponta para o proprio buffer de entrada (nenhuma copia por token), entao o
+// buffer precisa continuar vivo enquanto os tokens forem usados.
+//
+// Uso:
+//     Lexer lexer(inicio, fim);
+//     for (const Token& token : lexer) { ... }      // todos os tokens, sem o EOF
+// ou
+//     Token token = lexer.proximo();                // ate token.tipo == tk_eof
+//
+// Os erros lexicos nao interrompem a analise: ficam em lexer.diagnosticos,
+// na ordem em que foram encontrados, para o consumidor tratar.
+//
+// Tokens e erros trazem so o offset do primeiro byte; a linha e a coluna
+// saem de um IndiceLinhas (linhas.h) quando alguem precisa delas.
+//
+// Fora do ASCII cada caractere UTF-8 (utf8.h) gera um erro so, com o
+// caractere inteiro no lexema; uma sequencia invalida gera erro_utf8_invalido.
+// Um arquivo em outra codificacao teria um erro a cada poucos bytes, entao
+// depois de max_erros_codificacao desses erros vem um aviso
+// (erro_limite_codificacao) e os seguintes sao descartados.
+//
+// A entrada tambem pode chegar em partes (ver fluxo.h): com continuar(), o
+// analisador para no fim de cada parte sem emitir o lexema que ainda pode
+// continuar, e retoma na parte seguinte (inclusive dentro de comentarios).
+
+#ifndef LEXER_H
+#define LEXER_H
+
+#include <string_view>  // lexemas apontando para o buffer de entrada
+#include <vector>       // lista de diagnosticos
+#include <iterator>     // input_iterator_tag
+
+#include "tabelas.h"
+#include "simd.h"       // pulo vetorial de espacos e comentarios
+#include "simbolos.h"   // internacao dos identificadores
+#include "numeros.h"    // valor dos literais numericos
+#include "utf8.h"       // caracteres fora do ASCII
+
+// Versao dos tokens e diagnosticos produzidos: muda sempre que o mesmo texto
+// passar a gerar tokens, valores ou erros diferentes (invalida o cache.h)
+constexpr uint32_t versao_lexer = 2;
+
+// Valor decodificado de um NUM: 'inteiro' em tk_num_int, 'real' em tk_num_float
+union ValorNumero {
+    int64_t inteiro;
+    double real;
+};
+
+// Token produzido pelo analisador
+struct Token {
+    tipos_token tipo;
+    std::string_view lexema;    // trecho da entrada que formou o token
+    size_t offset;              // posicao do primeiro byte do lexema na entrada
+    uint32_t simbolo = sem_simbolo;     // id do identificador na tabela de simbolos do Lexer
+    ValorNumero valor{};                // valor do numero (0 se nao coube no tipo)
+};
+
+// Categorias de erro lexico
+enum categorias_erro : uint8_t {
+    erro_zero_esquerda_int,     // 009
+    erro_zero_esquerda_float,   // 00.5
+    erro_fracao_ausente,        // 53.
+    erro_caractere_invalido,    // @, #, ...
+    erro_operador_incompleto,   // '&' ou '|' sozinhos
+    erro_inteiro_fora_do_limite,    // inteiro que nao cabe em 64 bits
+    erro_float_fora_do_limite,      // float maior que o maior double (ou que so caberia como zero)
+    erro_utf8_invalido,         // bytes que nao formam um caractere UTF-8
+    erro_limite_codificacao,    // erros fora do ASCII demais: os seguintes foram omitidos
+    total_categorias_erro
+};
+
+// Erros fora do ASCII reportados antes do aviso de erro_limite_codificacao
+constexpr size_t max_erros_codificacao = 100;
+
+// Erro lexico encontrado durante a analise
+struct Diagnostico {
+    categorias_erro categoria;
+    std::string_view lexema;    // numero, operador ou caractere com erro
+    size_t offset;
+};
+
+// erro de um caractere fora do ASCII (os que contam para max_erros_codificacao)
+inline bool erro_de_codificacao(const Diagnostico& erro){
+    return erro.categoria == erro_utf8_invalido || erro.categoria == erro_limite_codificacao ||
+           (erro.categoria == erro_caractere_invalido && (unsigned char)erro.lexema[0] >= 0x80);
+}
+
+class Lexer {
+public:
+    std::vector<Diagnostico> diagnosticos;  // erros encontrados ate agora
+    TabelaSimbolos* simbolos = nullptr;     // se definida, cada ID recebe o id do seu nome
+    size_t limite_erros_codificacao = max_erros_codificacao;   // (size_t)-1: sem limite
+
+    Lexer(const char* inicio, const char* fim)
+        : inicio_entrada(inicio), p(inicio), fim(fim) {}
+
+    // analisa so o trecho [inicio, fim) de uma entrada maior, que deve comecar
+    // fora de comentarios e de lexemas (no inicio de um token, por exemplo);
+    // os offsets continuam
+    // relativos a inicio_entrada
+    Lexer(const char* inicio_entrada, const char* inicio, const char* fim)
+        : inicio_entrada(inicio_entrada), p(inicio), fim(fim) {}
+
+    // devolve o proximo token; depois do fim da entrada devolve sempre tk_eof
+    Token proximo();
+
+    // passa a analisar a parte [inicio, fim_parte), que continua a entrada a
+    // partir de pendente() (o lexema incompleto da parte anterior precisa
+    // estar copiado no inicio dela). Enquanto nao for a ultima parte, chegar
+    // em fim_parte faz proximo() devolver tk_eof com aguardando_dados() == true
+    void continuar(const char* inicio, const char* fim_parte, bool ultima_parte){
+        deslocamento += (size_t)(p - inicio_entrada);
+        inicio_entrada = p = inicio;
+        fim = fim_parte;
+        parcial = !ultima_parte;
+        aguardando = false;
+    }
+
+    // o ultimo tk_eof so marca o fim da parte atual, nao o da entrada
+    bool aguardando_dados() const { return aguardando; }
+
+    // primeiro byte ainda nao consumido (inicio do lexema incompleto)
+    const char* pendente() const { return p; }
+
+    // percorre os tokens como um intervalo (range-for), parando antes do EOF
+    class iterador {
+    public:
+        using iterator_category = std::input_iterator_tag;
+        using value_type = Token;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const Token*;
+        using reference = const Token&;
+
+        iterador() = default;
+        explicit iterador(Lexer* lexer) : lexer(lexer) { avancar(); }
+
+        const Token& operator*() const { return atual; }
+        const Token* operator->() const { return &atual; }
+        iterador& operator++() { avancar(); return *this; }
+        void operator++(int) { avancar(); }
+        bool operator==(const iterador& outro) const { return lexer == outro.lexer; }
+        bool operator!=(const iterador& outro) const { return lexer != outro.lexer; }
+
+    private:
+        Lexer* lexer = nullptr;     // nullptr marca o fim
+        Token atual{};
+
+        void avancar(){
+            atual = lexer->proximo();
+            if (atual.tipo == tk_eof) lexer = nullptr;
+        }
+    };
+
+    iterador begin() { return iterador(this); }
+    iterador end() { return iterador(); }
+
+private:
+    const char* inicio_entrada;
+    const char* p;      // proximo caractere a ser lido
+    const char* fim;
+
+    // entrada em partes
+    size_t deslocamento = 0;    // offset de inicio_entrada na entrada completa
+    bool parcial = false;       // fim ainda nao eh o fim da entrada
+    bool aguardando = false;    // parou no fim da parte atual
+    bool em_comentario = false; // a parte atual terminou dentro de um comentario
+
+    size_t erros_codificacao = 0;   // erros fora do ASCII, reportados ou nao
+
+    Token criar_token(tipos_token tipo, const char* inicio_lexema) const {
+        return {tipo, std::string_view(inicio_lexema, p - inicio_lexema),
+                (size_t)(inicio_lexema - inicio_entrada) + deslocamento};
+    }
+
+    Token aguardar_dados(){
+        aguardando = true;
+        return criar_token(tk_eof, p);
+    }
+
+    // pula o resto de um comentario ja aberto (p esta depois do "/*");
+    // retorna true se achou o "*/". Numa parte que nao eh a ultima, um
+    // comentario sem fechamento fica marcado em em_comentario
+    bool fechar_comentario(){
+        Pulo pulo = rotinas_simd.pular_comentario(p, fim);
+        if (!pulo.fechou && parcial){
+            // um '*' no ultimo byte ainda pode fechar com o '/' da proxima parte
+            if (pulo.fim > p && pulo.fim[-1] == '*') pulo.fim--;
+            em_comentario = true;
+        }
+        p = pulo.fim;
+        return pulo.fechou;
+    }
+
+    void reportar(categorias_erro categoria, const char* inicio_lexema, size_t tamanho){
+        diagnosticos.push_back({categoria, std::string_view(inicio_lexema, tamanho),
+                                (size_t)(inicio_lexema - inicio_entrada) + deslocamento});
+    }
+
+    // caractere fora do ASCII em inicio_lexema (p logo depois do primeiro
+    // byte); retorna false se ele pode continuar na proxima parte
+    bool reportar_fora_do_ascii(const char* inicio_lexema){
+        // passado o limite, pula o trecho todo sem olhar caractere por caractere
+        if (erros_codificacao > limite_erros_codificacao){
+            while (p < fim && (unsigned char)*p >= 0x80) p++;
+            return true;
+        }
+        SequenciaUtf8 caractere = decodificar_utf8(inicio_lexema, fim);
+        if (caractere.incompleta && parcial) return false;
+        p = inicio_lexema + caractere.tamanho;
+
+        categorias_erro categoria = caractere.valida ? erro_caractere_invalido : erro_utf8_invalido;
+        if (erros_codificacao == limite_erros_codificacao) categoria = erro_limite_codificacao;
+        reportar(categoria, inicio_lexema, caractere.tamanho);
+        erros_codificacao++;
+        return true;
+    }
+};
+
+// percorre o automato de tabelas.h: cada caractere custa uma consulta a
+// tabela de classes e outra a tabela de transicoes; o token so eh emitido
+// quando a transicao indica que o lexema terminou (bit 'aceita')
+inline Token Lexer::proximo(){
+    const char* inicio_lexema = p;      // primeiro caractere do lexema atual
+    uint8_t estado = inicio;
+
+    // a parte anterior da entrada terminou dentro de um comentario
+    if (em_comentario){
+        em_comentario = false;
+        if (!fechar_comentario()){
+            if (em_comentario) return aguardar_dados();
+            estado = comentario;
+        }
+    }
+
+    while (true){
+        uint8_t classe;
+        if (p < fim){
+            classe = tabela_classes[(unsigned char)*p];
+        } else {
+            // fim de uma parte: o lexema pode continuar na proxima, entao
+            // volta para o inicio dele e espera mais dados
+            if (parcial){
+                if (estado != inicio) p = inicio_lexema;
+                return aguardar_dados();
+            }
+            classe = fim_do_arquivo;
+        }
+        uint8_t transicao = tabela_transicoes[estado][classe];
+
+        if (!(transicao & aceita)){
+            if (estado == inicio){
+                // sequencias de espacos e quebras de linha sao puladas em bloco
+                // (um espaco isolado entre tokens segue pelo automato mesmo)
+                if ((classe == espaco_em_branco || classe == quebra_linha) && p + 1 < fim &&
+                    (tabela_classes[(unsigned char)p[1]] == espaco_em_branco || tabela_classes[(unsigned char)p[1]] == quebra_linha)){
+                    p = rotinas_simd.pular_espacos(p, fim).fim;
+                    continue;
+                }
+                inicio_lexema = p;
+            }
+            estado = transicao & mascara_estado;
+            if (estado == estado_fim_de_arquivo)
+                return criar_token(tk_eof, p);
+            p++;
+
+            // identificadores e numeros: acha o fim da sequencia de uma vez;
+            // a proxima volta do laco ve o caractere que encerra o lexema
+            if (estado == id){
+                p = rotinas_simd.fim_identificador(p, fim);
+            } else if (estado == numero){
+                const char* fim_lexema = rotinas_simd.fim_digitos(p, fim);
+                if (fim_lexema < fim && *fim_lexema == '.'){
+                    estado = decimal;
+                    fim_lexema = rotinas_simd.fim_digitos(fim_lexema + 1, fim);
+                }
+                p = fim_lexema;
+            }
+
+            // "/*" acabou de abrir um comentario: pula direto ate o "*/"
+            else if (estado == comentario){
+                if (fechar_comentario()) estado = inicio;
+                else if (em_comentario) return aguardar_dados();
+            }
+            continue;
+        }
+
+        // o lexema [inicio_lexema, p) terminou: emite o token do estado atual
+        switch (estado){
+            // Identificadores ou palavras reservadas
+            case id: {
+                Token token = criar_token(classificar_palavra(inicio_lexema, p - inicio_lexema), inicio_lexema);
+                if (simbolos != nullptr && token.tipo == tk_id)
+                    token.simbolo = simbolos->internar(token.lexema);
+                return token;
+            }
+
+            // Numeros inteiros
+            case numero: {
+                if (p - inicio_lexema > 1 && inicio_lexema[0] == '0')
+                    reportar(erro_zero_esquerda_int, inicio_lexema, p - inicio_lexema);
+                Token token = criar_token(tk_num_int, inicio_lexema);
+                if (!decodificar_inteiro(inicio_lexema, p, token.valor.inteiro))
+                    reportar(erro_inteiro_fora_do_limite, inicio_lexema, p - inicio_lexema);
+                return token;
+            }
+
+            // Numeros com ponto decimal
+            case decimal: {
+                const char* ponto = inicio_lexema;
+                while (*ponto != '.') ponto++;
+                if (ponto - inicio_lexema > 1 && inicio_lexema[0] == '0')
+                    reportar(erro_zero_esquerda_float, inicio_lexema, p - inicio_lexema);
+                if (ponto + 1 == p)
+                    reportar(erro_fracao_ausente, inicio_lexema, p - inicio_lexema);
+                Token token = criar_token(tk_num_float, inicio_lexema);
+                if (!decodificar_real(inicio_lexema, p, token.valor.real))
+                    reportar(erro_float_fora_do_limite, inicio_lexema, p - inicio_lexema);
+                return token;
+            }
+
+            // '/' que nao abriu comentario eh divisao
+            case estado_barra:
+                return criar_token(tk_div, inicio_lexema);
+
+            // Simbolos e operadores: o segundo caractere so eh consumido
+            // quando completa o operador composto
+            case estado_operador:
+            case estado_delimitador: {
+                const info_simbolo& simbolo = tabela_operadores[(unsigned char)*inicio_lexema];
+                if (simbolo.segundo != 0 && p < fim && *p == simbolo.segundo){
+                    p++;
+                    return criar_token(simbolo.composto, inicio_lexema);
+                }
+                if (simbolo.simples != tk_erro)
+                    return criar_token(simbolo.simples, inicio_lexema);
+                // '&' e '|' nao existem sozinhos
+                reportar(erro_operador_incompleto, inicio_lexema, 1);
+                break;
+            }
+
+            // Caso não seja simbolo conhecido, reporta erro
+            case estado_erro:
+                if ((unsigned char)*inicio_lexema < 0x80){
+                    reportar(erro_caractere_invalido, inicio_lexema, 1);
+                } else if (!reportar_fora_do_ascii(inicio_lexema)){
+                    p = inicio_lexema;
+                    return aguardar_dados();
+                }
+                break;
+
+            // comentario sem fechamento: termina junto com o arquivo
+            default:
+                break;
+        }
+        estado = inicio;
+    }
+}
+
+#endif
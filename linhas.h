@@ -0,0 +1,175 @@
+// Compiladores 2025.1 - Indice de linhas
+//
+// Tokens e erros guardam so o offset do primeiro byte: o Lexer nao conta
+// linhas nem colunas. Quem precisa delas (mensagens de erro, --format=jsonl,
+// estatisticas) pergunta ao IndiceLinhas, que na primeira consulta grava o
+// offset de cada quebra de linha do texto (varredura vetorial de simd.h) e
+// depois responde por busca binaria. Consultas em ordem crescente, o caso
+// comum, so conferem a linha anterior e a seguinte.
+//
+// Em um fluxo lido em blocos (fluxo.h) o indice cobre so o bloco atual (a
+// janela); do trecho ja analisado fica apenas quantas linhas ele tinha e
+// onde comeca a linha em que ele terminou.
+//
+// A coluna conta caracteres UTF-8 a partir de 1 (um tab vale uma coluna); um
+// trecho invalido conta como um caractere, o mesmo que gera um erro no Lexer
+// (e que um editor mostraria como um U+FFFD). Uma passada vetorial ao indexar
+// confirma se a janela eh toda ASCII, o caso comum, e entao a coluna sai
+// direto da diferenca de offsets.
+
+#ifndef LINHAS_H
+#define LINHAS_H
+
+#include <algorithm>    // lower_bound
+#include <cstddef>
+#include <vector>
+
+#include "simd.h"       // indexar_quebras, contar_quebras, fim_ascii
+#include "utf8.h"       // colunas fora do ASCII
+
+// Linha e coluna de um byte, ambas a partir de 1
+struct PosicaoTexto {
+    int linha;
+    int coluna;
+};
+
+// Bytes alem do primeiro de cada caractere de uma linha: a coluna eh o total
+// de bytes menos esses. Os trechos so de ASCII sao pulados pela rotina
+// vetorial. Um caractere cortado no fim dos dados (o bloco de um fluxo)
+// continua nos primeiros bytes do bloco seguinte
+struct ContagemColunas {
+    size_t extras = 0;
+    size_t faltando = 0;    // bytes de continuacao do caractere cortado
+
+    // conta os caracteres que comecam em [p, ate), lendo ate 'fim' se o
+    // ultimo passa de 'ate'; retorna onde ele termina
+    const char* avancar(const char* p, const char* ate, const char* fim){
+        for (; faltando > 0 && p < fim && ((unsigned char)*p & 0xc0) == 0x80; faltando--, p++) extras++;
+        faltando = 0;
+        while ((p = rotinas_simd.fim_ascii(p, ate)) < ate){
+            SequenciaUtf8 caractere = decodificar_utf8(p, fim);
+            extras += caractere.tamanho - 1;
+            if (caractere.incompleta){
+                unsigned char primeiro = (unsigned char)*p;
+                faltando = (primeiro >= 0xf0 ? 4 : primeiro >= 0xe0 ? 3 : 2) - caractere.tamanho;
+            }
+            p += caractere.tamanho;
+        }
+        return p;
+    }
+};
+
+class IndiceLinhas {
+public:
+    IndiceLinhas() = default;
+
+    // texto completo [inicio, fim), com offsets a partir de inicio
+    IndiceLinhas(const char* inicio, const char* fim) : inicio(inicio), fim(fim) {}
+
+    // linha e coluna do byte 'offset', que precisa estar na janela atual (ou
+    // ser o fim dela)
+    PosicaoTexto posicao(size_t offset){
+        if (!indexado) indexar();
+        if (!na_linha(ultima, offset)){
+            if (na_linha(ultima + 1, offset)) ultima++;
+            else ultima = (size_t)(std::lower_bound(quebras.begin(), quebras.end(), offset) - quebras.begin());
+        }
+        size_t inicio_linha = ultima > 0 ? quebras[ultima - 1] + 1 : inicio_linha_janela;
+        size_t coluna = offset - inicio_linha;
+        if (!ascii) coluna -= extras_ate(inicio_linha, offset);
+        return {linha_janela + (int)ultima, (int)coluna + 1};
+    }
+
+    // Fluxos: esquece o trecho [inicio da janela, ate), ja analisado, guardando
+    // so as linhas que ele tinha. Depois disso a janela so volta a valer com
+    // mudar_janela() (o buffer costuma ser reaproveitado no meio tempo)
+    void descartar_ate(const char* ate){
+        size_t linhas = rotinas_simd.contar_quebras(inicio, ate);
+        const char* contar_de = inicio + (contado_janela - offset_janela);
+        if (linhas > 0){
+            const char* ultima_quebra = ate - 1;
+            while (*ultima_quebra != '\n') ultima_quebra--;
+            linha_janela += (int)linhas;
+            inicio_linha_janela = offset_janela + (size_t)(ultima_quebra + 1 - inicio);
+            colunas_janela = ContagemColunas{};
+            contar_de = ultima_quebra + 1;
+        }
+        contado_janela = offset_janela + (size_t)(colunas_janela.avancar(contar_de, ate, fim) - inicio);
+        offset_janela += (size_t)(ate - inicio);
+        inicio = fim = nullptr;
+        esquecer();
+    }
+
+    // a janela passa a ser [novo_inicio, novo_fim), com o mesmo offset do
+    // primeiro byte nao descartado
+    void mudar_janela(const char* novo_inicio, const char* novo_fim){
+        inicio = novo_inicio;
+        fim = novo_fim;
+        esquecer();
+    }
+
+private:
+    const char* inicio = nullptr;
+    const char* fim = nullptr;
+    size_t offset_janela = 0;           // offset de 'inicio' no texto completo
+    int linha_janela = 1;               // linha em que a janela comeca
+    size_t inicio_linha_janela = 0;     // offset do inicio dessa linha
+    ContagemColunas colunas_janela;     // dessa linha, ate o inicio da janela
+    size_t contado_janela = 0;          // offset ate onde ela foi contada (o ultimo caractere pode entrar na janela)
+    std::vector<size_t> quebras;        // offsets das quebras de linha da janela
+    size_t ultima = 0;                  // quebras antes da ultima posicao consultada
+    bool indexado = false;
+    bool ascii = true;                  // a janela (e o comeco da linha dela) so tem ASCII
+
+    // ultima consulta fora do ASCII: a linha que comeca em contada_linha,
+    // contada ate o offset contada_ate
+    size_t contada_linha = (size_t)-1;
+    size_t contada_ate = 0;
+    size_t consultada = 0;
+    ContagemColunas contagem;
+
+    // 'offset' esta depois de k quebras da janela (e nao de k + 1)
+    bool na_linha(size_t k, size_t offset) const {
+        return k <= quebras.size() && (k == 0 || quebras[k - 1] < offset) && (k == quebras.size() || quebras[k] >= offset);
+    }
+
+    void esquecer(){
+        quebras.clear();
+        ultima = 0;
+        indexado = false;
+        contada_linha = (size_t)-1;
+    }
+
+    // bytes extras entre inicio_linha e offset, na mesma linha; consultas em
+    // ordem crescente na mesma linha continuam a contagem anterior, entao
+    // muitos erros numa linha longa nao custam tempo quadratico
+    size_t extras_ate(size_t inicio_linha, size_t offset){
+        if (contada_linha != inicio_linha || offset < consultada){
+            contada_linha = inicio_linha;
+            contagem = inicio_linha < offset_janela ? colunas_janela : ContagemColunas{};
+            contada_ate = inicio_linha < offset_janela ? contado_janela : inicio_linha;
+        }
+        consultada = offset;
+        if (contada_ate < offset){
+            const char* ate = contagem.avancar(inicio + (contada_ate - offset_janela), inicio + (offset - offset_janela), fim);
+            contada_ate = offset_janela + (size_t)(ate - inicio);
+        }
+        return contagem.extras;
+    }
+
+    // grava as quebras da janela em pedacos de 4 KiB, por um buffer na pilha
+    // (reservar o pior caso, uma quebra por byte, custaria 8x o texto)
+    void indexar(){
+        size_t pedaco[4096];
+        for (const char* p = inicio; p < fim; ){
+            const char* fim_pedaco = (size_t)(fim - p) > 4096 ? p + 4096 : fim;
+            size_t n = rotinas_simd.indexar_quebras(p, fim_pedaco, offset_janela + (size_t)(p - inicio), pedaco);
+            quebras.insert(quebras.end(), pedaco, pedaco + n);
+            p = fim_pedaco;
+        }
+        ascii = colunas_janela.extras == 0 && colunas_janela.faltando == 0 && rotinas_simd.fim_ascii(inicio, fim) == fim;
+        indexado = true;
+    }
+};
+
+#endif
@@ -0,0 +1,841 @@
+// Compiladores 2025.1 - Codigo nativo x86-64
+//
+// Traduz o ProgramaBytecode (bytecode.h) para assembly x86-64 na sintaxe do
+// GNU as (AT&T), para o linux (convencao de chamada System V). O programa
+// vira a funcao cmm_programa, que retorna o valor do return; print, readln
+// e os erros de execucao chamam o runtime de runtime_nativo.cpp, que tem o
+// main. O executavel sai do proprio compilador C++ (--nativo=executavel no
+// analisador), com a mesma saida e o mesmo codigo de saida do --executar.
+//
+// Cada registrador do bytecode tem uma posicao na pilha, zerada na entrada;
+// as constantes viram imediatos ou ficam em .rodata. A alocacao de
+// registradores eh simples: cada registrador do bytecode tem um peso, a
+// soma dos seus usos, em que um uso dentro de um laco vale 10 vezes mais por
+// nivel, e os mais pesados ocupam um registrador da maquina durante o
+// programa inteiro (de uso geral se a maioria dos usos eh inteira, xmm se eh
+// float). Os registradores que uma chamada ao runtime pode alterar sao
+// guardados nas suas posicoes antes dela e recarregados depois.
+//
+// As instrucoes seguem a VM (vm.h): os inteiros dao a volta em 64 bits, a
+// divisao por -1 nao gera excecao e float -> int satura (NaN vira 0).
+
+#ifndef NATIVO_H
+#define NATIVO_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>          // getenv
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "bytecode.h"
+#include "linhas.h"
+#include "saida.h"          // CanalSaida
+#include "vm.h"             // mensagens dos erros de execucao
+
+#ifndef _WIN32
+#include <climits>          // PATH_MAX
+#include <cstdio>           // rename, remove
+#include <sys/stat.h>       // stat
+#include <sys/wait.h>       // waitpid
+#include <unistd.h>         // fork, execvp, readlink
+#endif
+
+// Erros de execucao que o codigo gerado entrega ao runtime (cmm_falhar)
+enum erros_nativos : uint8_t {
+    nativo_divisao_zero, nativo_resto_zero, nativo_leitura_int, nativo_leitura_float
+};
+
+constexpr const char* mensagens_erros_nativos[] = {
+    erro_divisao_zero, erro_resto_zero, erro_leitura_int, erro_leitura_float
+};
+
+class GeradorNativo {
+public:
+    GeradorNativo(const ProgramaBytecode& programa, IndiceLinhas& linhas, CanalSaida& canal)
+        : programa(programa), linhas(linhas), canal(canal) {}
+
+    void gerar(){
+        alocar();
+        const size_t total = programa.registradores_iniciais.size();
+        quadro = (preservados + total) * 8;
+        quadro = (quadro + 15) & ~(size_t)15;   // a pilha fica alinhada em 16 nas chamadas
+
+        std::vector<bool> alvos(programa.codigo.size() + 1, false);
+        for (const Instrucao& instrucao : programa.codigo){
+            if (eh_desvio(instrucao.op)) alvos[alvo(instrucao)] = true;
+        }
+
+        canal.escrever("\t.text\n\t.globl\tcmm_programa\n\t.type\tcmm_programa, @function\ncmm_programa:\n");
+        emitir("pushq", "%rbp");
+        emitir("movq", "%rsp", "%rbp");
+        emitir("subq", "$" + std::to_string(quadro), "%rsp");
+        for (int g = 0; g < preservados; g++){
+            if (usado_geral[g]) emitir("movq", gerais[g], posicao_salva(g));
+        }
+        // as variaveis comecam com 0
+        emitir("leaq", "-" + std::to_string((preservados + total) * 8) + "(%rbp)", "%rdi");
+        emitir("movq", "$" + std::to_string(total), "%rcx");
+        emitir("xorl", "%eax", "%eax");
+        emitir("rep stosq");
+        for (int g = 0; g < total_gerais; g++){
+            if (usado_geral[g]) emitir("xorq", gerais[g], gerais[g]);
+        }
+        for (int x = 0; x < total_xmm; x++){
+            if (usado_xmm[x]) emitir("xorpd", xmms[x], xmms[x]);
+        }
+
+        for (size_t i = 0; i < programa.codigo.size(); i++){
+            if (alvos[i]) rotulo(".L" + std::to_string(i));
+            canal.escrever("\t# ");
+            canal.escrever_numero((int64_t)i);
+            canal.escrever("  ");
+            canal.escrever(nomes_bytecode[programa.codigo[i].op]);
+            canal.escrever("\n");
+            instrucao(i);
+            canal.verificar();
+        }
+
+        rotulo(".Lsair");
+        for (int g = 0; g < preservados; g++){
+            if (usado_geral[g]) emitir("movq", posicao_salva(g), gerais[g]);
+        }
+        emitir("leave");
+        emitir("ret");
+
+        // caminhos raros (erros, saturacao), fora do fluxo principal
+        canal.escrever(frio.buffer);
+        canal.escrever("\t.size\tcmm_programa, .-cmm_programa\n");
+
+        canal.escrever("\n\t.section\t.rodata\n\t.align\t16\n.Lsinal:\n\t.quad\t0x8000000000000000, 0\n"
+                       ".Lum:\n\t.quad\t0x3ff0000000000000\n");
+        for (uint32_t r = 0; r < programa.fixos.size(); r++){
+            if (!eh_constante(r)) continue;
+            rotulo(".Lk" + std::to_string(r));
+            emitir(".quad", std::to_string(programa.registradores_iniciais[r].i));
+        }
+        canal.escrever("\t.section\t.note.GNU-stack,\"\",@progbits\n");
+        canal.verificar();
+    }
+
+private:
+    // registradores alocaveis: os 5 primeiros de uso geral sobrevivem as
+    // chamadas (callee-saved); os demais e todos os xmm sao guardados em
+    // volta delas. rax, rcx, rdx, xmm0 e xmm1 ficam livres para as contas
+    static constexpr int preservados = 5;
+    static constexpr int total_gerais = 11;
+    static constexpr int total_xmm = 14;
+    static constexpr const char* gerais[total_gerais] = {
+        "%rbx", "%r12", "%r13", "%r14", "%r15", "%rsi", "%rdi", "%r8", "%r9", "%r10", "%r11"
+    };
+    static constexpr const char* xmms[total_xmm] = {
+        "%xmm2", "%xmm3", "%xmm4", "%xmm5", "%xmm6", "%xmm7", "%xmm8",
+        "%xmm9", "%xmm10", "%xmm11", "%xmm12", "%xmm13", "%xmm14", "%xmm15"
+    };
+
+    enum tipos_local : uint8_t { local_pilha, local_geral, local_xmm };
+    enum tipos_uso : uint8_t { uso_int, uso_float, uso_qualquer };
+
+    struct Local {
+        tipos_local tipo = local_pilha;
+        uint8_t indice = 0;
+    };
+
+    const ProgramaBytecode& programa;
+    IndiceLinhas& linhas;
+    CanalSaida& canal;
+    CanalSaida frio;                // em memoria, emitido depois do epilogo
+    std::vector<Local> locais;
+    std::vector<uint32_t> alocados;     // registradores do bytecode que ficam na maquina
+    bool usado_geral[total_gerais] = {};
+    bool usado_xmm[total_xmm] = {};
+    size_t quadro = 0;
+
+    static bool eh_desvio(uint32_t op){ return op >= op_jmp && op <= op_jne_i; }
+
+    static uint32_t alvo(const Instrucao& instrucao){
+        if (instrucao.op == op_jmp) return instrucao.a;
+        if (instrucao.op == op_jz || instrucao.op == op_jnz) return instrucao.b;
+        return instrucao.c;
+    }
+
+    // chama f(registrador, tipo) para cada operando registrador da instrucao
+    template<class F>
+    static void usos(const Instrucao& instrucao, F f){
+        switch (instrucao.op){
+            case op_mov:
+                f(instrucao.a, uso_qualquer);
+                f(instrucao.b, uso_qualquer);
+                break;
+            case op_add_f: case op_sub_f: case op_mul_f: case op_div_f:
+                f(instrucao.a, uso_float);
+                f(instrucao.b, uso_float);
+                f(instrucao.c, uso_float);
+                break;
+            case op_lt_f: case op_le_f: case op_gt_f: case op_ge_f: case op_eq_f: case op_ne_f:
+                f(instrucao.a, uso_int);
+                f(instrucao.b, uso_float);
+                f(instrucao.c, uso_float);
+                break;
+            case op_neg_f:
+                f(instrucao.a, uso_float);
+                f(instrucao.b, uso_float);
+                break;
+            case op_neg_i: case op_not_i:
+                f(instrucao.a, uso_int);
+                f(instrucao.b, uso_int);
+                break;
+            case op_i2f:
+                f(instrucao.a, uso_float);
+                f(instrucao.b, uso_int);
+                break;
+            case op_f2i:
+                f(instrucao.a, uso_int);
+                f(instrucao.b, uso_float);
+                break;
+            case op_inc_f: case op_dec_f: case op_print_f: case op_read_f:
+                f(instrucao.a, uso_float);
+                break;
+            case op_inc_i: case op_dec_i: case op_print_i: case op_read_i: case op_ret:
+            case op_jz: case op_jnz:
+                f(instrucao.a, uso_int);
+                break;
+            case op_jmp:
+                break;
+            case op_jlt_i: case op_jle_i: case op_jgt_i: case op_jge_i: case op_jeq_i: case op_jne_i:
+                f(instrucao.a, uso_int);
+                f(instrucao.b, uso_int);
+                break;
+            default:    // aritmetica e comparacoes inteiras
+                f(instrucao.a, uso_int);
+                f(instrucao.b, uso_int);
+                f(instrucao.c, uso_int);
+                break;
+        }
+    }
+
+    bool eh_constante(uint32_t r) const {
+        return r < programa.fixos.size() &&
+               (programa.fixos[r] == constante_int || programa.fixos[r] == constante_float);
+    }
+
+    // constante inteira que cabe num imediato de 32 bits
+    bool eh_imediato(uint32_t r) const {
+        if (!eh_constante(r) || programa.fixos[r] != constante_int) return false;
+        int64_t valor = programa.registradores_iniciais[r].i;
+        return valor >= INT32_MIN && valor <= INT32_MAX;
+    }
+
+    void alocar(){
+        const std::vector<Instrucao>& codigo = programa.codigo;
+        const size_t total = programa.registradores_iniciais.size();
+        locais.assign(total, Local{});
+
+        // profundidade de laco de cada instrucao: um desvio para tras fecha um laco
+        std::vector<int> variacao(codigo.size() + 1, 0);
+        for (size_t i = 0; i < codigo.size(); i++){
+            if (eh_desvio(codigo[i].op) && alvo(codigo[i]) <= i){
+                variacao[alvo(codigo[i])]++;
+                variacao[i + 1]--;
+            }
+        }
+
+        // os usos tipados contam 2 para o seu tipo; os do MOV, 1 para cada
+        std::vector<uint64_t> peso_int(total, 0), peso_float(total, 0);
+        int profundidade = 0;
+        for (size_t i = 0; i < codigo.size(); i++){
+            profundidade += variacao[i];
+            uint64_t peso = 1;
+            for (int nivel = 0; nivel < std::min(profundidade, 6); nivel++) peso *= 10;
+            usos(codigo[i], [&](uint32_t r, tipos_uso uso){
+                if (uso != uso_float) peso_int[r] += uso == uso_int ? 2 * peso : peso;
+                if (uso != uso_int) peso_float[r] += uso == uso_float ? 2 * peso : peso;
+            });
+        }
+
+        std::vector<uint32_t> candidatos;
+        for (uint32_t r = 0; r < total; r++){
+            if (!eh_constante(r) && peso_int[r] + peso_float[r] > 0) candidatos.push_back(r);
+        }
+        std::stable_sort(candidatos.begin(), candidatos.end(), [&](uint32_t a, uint32_t b){
+            return peso_int[a] + peso_float[a] > peso_int[b] + peso_float[b];
+        });
+        int proximo_geral = 0, proximo_xmm = 0;
+        for (uint32_t r : candidatos){
+            if (peso_float[r] > peso_int[r]){
+                if (proximo_xmm < total_xmm){
+                    usado_xmm[proximo_xmm] = true;
+                    locais[r] = {local_xmm, (uint8_t)proximo_xmm++};
+                    alocados.push_back(r);
+                }
+            } else if (proximo_geral < total_gerais){
+                usado_geral[proximo_geral] = true;
+                locais[r] = {local_geral, (uint8_t)proximo_geral++};
+                alocados.push_back(r);
+            }
+        }
+    }
+
+    // ---- emissao ----
+
+    void emitir(std::string_view instrucao, std::string_view a = {}, std::string_view b = {}, CanalSaida* destino = nullptr){
+        CanalSaida& saida = destino ? *destino : canal;
+        saida.escrever("\t");
+        saida.escrever(instrucao);
+        if (!a.empty()){
+            saida.escrever("\t");
+            saida.escrever(a);
+        }
+        if (!b.empty()){
+            saida.escrever(", ");
+            saida.escrever(b);
+        }
+        saida.escrever("\n");
+    }
+
+    void rotulo(const std::string& nome, CanalSaida* destino = nullptr){
+        CanalSaida& saida = destino ? *destino : canal;
+        saida.escrever(nome);
+        saida.escrever(":\n");
+    }
+
+    std::string posicao_salva(int g) const {
+        return "-" + std::to_string((g + 1) * 8) + "(%rbp)";
+    }
+
+    // posicao do registrador na pilha, ou a constante em .rodata
+    std::string memoria(uint32_t r) const {
+        if (eh_constante(r)) return ".Lk" + std::to_string(r) + "(%rip)";
+        return "-" + std::to_string((preservados + 1 + (size_t)r) * 8) + "(%rbp)";
+    }
+
+    bool em_geral(uint32_t r) const { return locais[r].tipo == local_geral; }
+    bool em_xmm(uint32_t r) const { return locais[r].tipo == local_xmm; }
+    const char* nome(uint32_t r) const {
+        return em_geral(r) ? gerais[locais[r].indice] : xmms[locais[r].indice];
+    }
+
+    // operando com o valor inteiro de r (registrador, imediato ou memoria);
+    // de um xmm o valor passa por 'auxiliar'
+    std::string fonte_int(uint32_t r, const char* auxiliar){
+        if (em_geral(r)) return nome(r);
+        if (eh_imediato(r)) return "$" + std::to_string(programa.registradores_iniciais[r].i);
+        if (em_xmm(r)){
+            emitir("movq", nome(r), auxiliar);
+            return auxiliar;
+        }
+        return memoria(r);
+    }
+
+    void carregar_int(uint32_t r, const char* destino){
+        std::string fonte = fonte_int(r, destino);
+        if (fonte != destino) emitir("movq", fonte, destino);
+    }
+
+    void guardar_int(uint32_t r, const char* origem){
+        if (em_geral(r)){
+            if (origem != std::string_view(nome(r))) emitir("movq", origem, nome(r));
+        } else {
+            emitir("movq", origem, em_xmm(r) ? nome(r) : memoria(r));
+        }
+    }
+
+    // operando com o valor float de r (xmm ou memoria); de um registrador
+    // de uso geral o valor passa por 'auxiliar'
+    std::string fonte_float(uint32_t r, const char* auxiliar){
+        if (em_xmm(r)) return nome(r);
+        if (em_geral(r)){
+            emitir("movq", nome(r), auxiliar);
+            return auxiliar;
+        }
+        return memoria(r);
+    }
+
+    void carregar_float(uint32_t r, const char* destino){
+        if (em_xmm(r)){
+            if (destino != std::string_view(nome(r))) emitir("movapd", nome(r), destino);
+        } else if (em_geral(r)){
+            emitir("movq", nome(r), destino);
+        } else {
+            emitir("movsd", memoria(r), destino);
+        }
+    }
+
+    void guardar_float(uint32_t r, const char* origem){
+        if (em_xmm(r)){
+            if (origem != std::string_view(nome(r))) emitir("movapd", origem, nome(r));
+        } else if (em_geral(r)){
+            emitir("movq", origem, nome(r));
+        } else {
+            emitir("movsd", origem, memoria(r));
+        }
+    }
+
+    // registrador da maquina onde calcular o resultado d: o do proprio d,
+    // se ele nao for tambem o operando 'outro' (lido depois do primeiro)
+    const char* destino_int(uint32_t d, uint32_t outro) const {
+        return em_geral(d) && d != outro ? nome(d) : "%rax";
+    }
+    const char* destino_float(uint32_t d, uint32_t outro) const {
+        return em_xmm(d) && d != outro ? nome(d) : "%xmm0";
+    }
+
+    // o runtime pode alterar os registradores que nao sao callee-saved
+    void salvar_volateis(){
+        for (uint32_t r : alocados){
+            if (em_geral(r) && locais[r].indice >= preservados) emitir("movq", nome(r), memoria(r));
+            else if (em_xmm(r)) emitir("movsd", nome(r), memoria(r));
+        }
+    }
+    void restaurar_volateis(){
+        for (uint32_t r : alocados){
+            if (em_geral(r) && locais[r].indice >= preservados) emitir("movq", memoria(r), nome(r));
+            else if (em_xmm(r)) emitir("movsd", memoria(r), nome(r));
+        }
+    }
+
+    // linha e coluna da instrucao i em rdi/rsi (ou rsi/rdx, depois do codigo de erro)
+    void passar_posicao(size_t i, const char* linha, const char* coluna, CanalSaida* destino = nullptr){
+        PosicaoTexto posicao = linhas.posicao(programa.offsets[i]);
+        emitir("movq", "$" + std::to_string(posicao.linha), linha, destino);
+        emitir("movq", "$" + std::to_string(posicao.coluna), coluna, destino);
+    }
+
+    // trecho frio que chama cmm_falhar (nao volta)
+    void erro_execucao(size_t i, const std::string& nome_rotulo, erros_nativos erro){
+        rotulo(nome_rotulo, &frio);
+        emitir("movl", "$" + std::to_string((int)erro), "%edi", &frio);
+        passar_posicao(i, "%rsi", "%rdx", &frio);
+        emitir("call", "cmm_falhar", {}, &frio);
+    }
+
+    static const char* condicao(uint32_t op){
+        switch (op){
+            case op_lt_i: case op_jlt_i: return "l";
+            case op_le_i: case op_jle_i: return "le";
+            case op_gt_i: case op_jgt_i: return "g";
+            case op_ge_i: case op_jge_i: return "ge";
+            case op_eq_i: case op_jeq_i: return "e";
+            default: return "ne";
+        }
+    }
+
+    static bool comparar(uint32_t op, int64_t a, int64_t b){
+        switch (op){
+            case op_jlt_i: return a < b;
+            case op_jle_i: return a <= b;
+            case op_jgt_i: return a > b;
+            case op_jge_i: return a >= b;
+            case op_jeq_i: return a == b;
+            default: return a != b;
+        }
+    }
+
+    // Divisao por constante d >= 2 sem idiv (Hacker's Delight, 10-1): o
+    // quociente eh a metade alta de n * M, deslocada, mais 1 se n < 0.
+    // Quociente (ou resto) em rdx
+    void dividir_por_constante(uint32_t n, int64_t divisor, bool divisao){
+        const uint64_t limite = 1ull << 63;
+        const uint64_t d = (uint64_t)divisor;
+        uint64_t anc = limite - 1 - limite % d;
+        uint64_t q1 = limite / anc, r1 = limite - q1 * anc;
+        uint64_t q2 = limite / d, r2 = limite - q2 * d;
+        int p = 63;
+        uint64_t delta;
+        do {
+            p++;
+            q1 *= 2;
+            r1 *= 2;
+            if (r1 >= anc){ q1++; r1 -= anc; }
+            q2 *= 2;
+            r2 *= 2;
+            if (r2 >= d){ q2++; r2 -= d; }
+            delta = d - r2;
+        } while (q1 < delta || (q1 == delta && r1 == 0));
+        int64_t magico = (int64_t)(q2 + 1);
+        int deslocamento = p - 64;
+
+        carregar_int(n, "%rcx");
+        emitir("movabsq", "$" + std::to_string(magico), "%rax");
+        emitir("imulq", "%rcx");
+        if (magico < 0) emitir("addq", "%rcx", "%rdx");
+        if (deslocamento > 0) emitir("sarq", "$" + std::to_string(deslocamento), "%rdx");
+        emitir("movq", "%rcx", "%rax");
+        emitir("shrq", "$63", "%rax");
+        emitir("addq", "%rax", "%rdx");
+        if (divisao) return;
+        // resto = n - q * d
+        if (divisor <= INT32_MAX){
+            emitir("imulq", "$" + std::to_string(divisor), "%rdx");
+        } else {
+            emitir("movabsq", "$" + std::to_string(divisor), "%rax");
+            emitir("imulq", "%rax", "%rdx");
+        }
+        emitir("subq", "%rdx", "%rcx");
+        emitir("movq", "%rcx", "%rdx");
+    }
+
+    void instrucao(size_t i){
+        Instrucao ins = programa.codigo[i];
+        const std::string sufixo = std::to_string(i);
+        // em x = y + x o resultado pode ser calculado direto em x
+        bool comutativa = ins.op == op_add_i || ins.op == op_mul_i || ins.op == op_add_f || ins.op == op_mul_f;
+        if (comutativa && ins.a == ins.c && ins.b != ins.c) std::swap(ins.b, ins.c);
+        switch ((codigos_bytecode)ins.op){
+            case op_mov: {
+                uint32_t d = ins.a, a = ins.b;
+                if (d == a) break;
+                if (em_xmm(d)){
+                    carregar_float(a, nome(d));
+                } else if (em_geral(d)){
+                    carregar_int(a, nome(d));
+                } else if (em_geral(a) || eh_imediato(a)){
+                    emitir("movq", fonte_int(a, "%rax"), memoria(d));
+                } else if (em_xmm(a)){
+                    emitir("movsd", nome(a), memoria(d));
+                } else {
+                    emitir("movq", memoria(a), "%rax");
+                    emitir("movq", "%rax", memoria(d));
+                }
+                break;
+            }
+
+            case op_add_i: case op_sub_i: case op_mul_i: {
+                const char* mnemonico = ins.op == op_add_i ? "addq" : ins.op == op_sub_i ? "subq" : "imulq";
+                const char* destino = destino_int(ins.a, ins.c);
+                carregar_int(ins.b, destino);
+                emitir(mnemonico, fonte_int(ins.c, "%rcx"), destino);
+                guardar_int(ins.a, destino);
+                break;
+            }
+
+            case op_div_i: case op_mod_i: {
+                bool divisao = ins.op == op_div_i;
+                const char* resultado = divisao ? "%rax" : "%rdx";
+                if (eh_constante(ins.c)){
+                    int64_t divisor = programa.registradores_iniciais[ins.c].i;
+                    if (divisor == 0){
+                        emitir("jmp", ".Lerro" + sufixo);
+                        erro_execucao(i, ".Lerro" + sufixo, divisao ? nativo_divisao_zero : nativo_resto_zero);
+                        break;
+                    }
+                    if (divisor >= 2){
+                        dividir_por_constante(ins.b, divisor, divisao);
+                        guardar_int(ins.a, "%rdx");
+                        break;
+                    }
+                    carregar_int(ins.b, "%rax");
+                    if (divisor == -1){
+                        if (divisao) emitir("negq", "%rax");
+                        else emitir("xorl", "%edx", "%edx");
+                    } else {
+                        carregar_int(ins.c, "%rcx");
+                        emitir("cqto");
+                        emitir("idivq", "%rcx");
+                    }
+                    guardar_int(ins.a, resultado);
+                    break;
+                }
+                carregar_int(ins.c, "%rcx");
+                emitir("testq", "%rcx", "%rcx");
+                emitir("je", ".Lerro" + sufixo);
+                carregar_int(ins.b, "%rax");
+                emitir("cmpq", "$-1", "%rcx");
+                emitir("je", ".Lmenos_um" + sufixo);
+                emitir("cqto");
+                emitir("idivq", "%rcx");
+                rotulo(".Lvolta" + sufixo);
+                guardar_int(ins.a, resultado);
+
+                erro_execucao(i, ".Lerro" + sufixo, divisao ? nativo_divisao_zero : nativo_resto_zero);
+                // x / -1 = -x e x % -1 = 0, sem a excecao do idiv com INT64_MIN
+                rotulo(".Lmenos_um" + sufixo, &frio);
+                if (divisao) emitir("negq", "%rax", {}, &frio);
+                else emitir("xorl", "%edx", "%edx", &frio);
+                emitir("jmp", ".Lvolta" + sufixo, {}, &frio);
+                break;
+            }
+
+            case op_add_f: case op_sub_f: case op_mul_f: case op_div_f: {
+                const char* mnemonico = ins.op == op_add_f ? "addsd" : ins.op == op_sub_f ? "subsd" :
+                                        ins.op == op_mul_f ? "mulsd" : "divsd";
+                const char* destino = destino_float(ins.a, ins.c);
+                carregar_float(ins.b, destino);
+                emitir(mnemonico, fonte_float(ins.c, "%xmm1"), destino);
+                guardar_float(ins.a, destino);
+                break;
+            }
+
+            case op_neg_i: {
+                const char* destino = destino_int(ins.a, ins.a);
+                carregar_int(ins.b, destino);
+                emitir("negq", destino);
+                guardar_int(ins.a, destino);
+                break;
+            }
+            case op_neg_f: {
+                const char* destino = destino_float(ins.a, ins.a);
+                carregar_float(ins.b, destino);
+                emitir("xorpd", ".Lsinal(%rip)", destino);
+                guardar_float(ins.a, destino);
+                break;
+            }
+            case op_not_i:
+                carregar_int(ins.b, "%rax");
+                emitir("xorl", "%ecx", "%ecx");
+                emitir("testq", "%rax", "%rax");
+                emitir("sete", "%cl");
+                guardar_int(ins.a, "%rcx");
+                break;
+
+            case op_lt_i: case op_le_i: case op_gt_i: case op_ge_i: case op_eq_i: case op_ne_i: {
+                std::string esquerda = em_geral(ins.b) ? nome(ins.b) : "%rax";
+                carregar_int(ins.b, esquerda.c_str());
+                emitir("cmpq", fonte_int(ins.c, "%rcx"), esquerda);
+                emitir(std::string("set") + condicao(ins.op), "%al");
+                emitir("movzbl", "%al", "%eax");
+                guardar_int(ins.a, "%rax");
+                break;
+            }
+
+            // ucomisd so tem "acima" sem sinal: a < b vira b > a. Com NaN
+            // (nao ordenados) ZF, PF e CF ficam em 1
+            case op_lt_f: case op_le_f: case op_gt_f: case op_ge_f: case op_eq_f: case op_ne_f: {
+                bool inverter = ins.op == op_lt_f || ins.op == op_le_f;
+                carregar_float(inverter ? ins.c : ins.b, "%xmm0");
+                emitir("ucomisd", fonte_float(inverter ? ins.b : ins.c, "%xmm1"), "%xmm0");
+                if (ins.op == op_eq_f){
+                    emitir("sete", "%al");
+                    emitir("setnp", "%cl");
+                    emitir("andb", "%cl", "%al");
+                } else if (ins.op == op_ne_f){
+                    emitir("setne", "%al");
+                    emitir("setp", "%cl");
+                    emitir("orb", "%cl", "%al");
+                } else {
+                    emitir(ins.op == op_lt_f || ins.op == op_gt_f ? "seta" : "setae", "%al");
+                }
+                emitir("movzbl", "%al", "%eax");
+                guardar_int(ins.a, "%rax");
+                break;
+            }
+
+            case op_i2f: {
+                std::string fonte = em_geral(ins.b) ? std::string(nome(ins.b)) : memoria(ins.b);
+                if (em_xmm(ins.b)){
+                    emitir("movq", nome(ins.b), "%rax");
+                    fonte = "%rax";
+                }
+                const char* destino = destino_float(ins.a, ins.a);
+                emitir("pxor", destino, destino);
+                emitir("cvtsi2sdq", fonte, destino);
+                guardar_float(ins.a, destino);
+                break;
+            }
+            case op_f2i:
+                // cvttsd2si da INT64_MIN fora do intervalo e com NaN; o
+                // trecho frio satura como truncar() de vm.h
+                carregar_float(ins.b, "%xmm0");
+                emitir("cvttsd2siq", "%xmm0", "%rax");
+                emitir("cmpq", "$1", "%rax");
+                emitir("jo", ".Lsatura" + sufixo);
+                rotulo(".Lvolta" + sufixo);
+                guardar_int(ins.a, "%rax");
+
+                rotulo(".Lsatura" + sufixo, &frio);
+                emitir("xorl", "%eax", "%eax", &frio);
+                emitir("ucomisd", "%xmm0", "%xmm0", &frio);
+                emitir("jp", ".Lvolta" + sufixo, {}, &frio);
+                emitir("movq", "%xmm0", "%rax", &frio);
+                emitir("sarq", "$63", "%rax", &frio);      // -1 se negativo, 0 se positivo
+                emitir("notq", "%rax", {}, &frio);
+                emitir("btcq", "$63", "%rax", &frio);      // INT64_MIN ou INT64_MAX
+                emitir("jmp", ".Lvolta" + sufixo, {}, &frio);
+                break;
+
+            case op_inc_i: case op_dec_i: {
+                const char* mnemonico = ins.op == op_inc_i ? "addq" : "subq";
+                if (em_xmm(ins.a)){
+                    emitir("movq", nome(ins.a), "%rax");
+                    emitir(mnemonico, "$1", "%rax");
+                    emitir("movq", "%rax", nome(ins.a));
+                } else {
+                    emitir(mnemonico, "$1", em_geral(ins.a) ? std::string(nome(ins.a)) : memoria(ins.a));
+                }
+                break;
+            }
+            case op_inc_f: case op_dec_f: {
+                const char* destino = destino_float(ins.a, ins.a);
+                carregar_float(ins.a, destino);
+                emitir(ins.op == op_inc_f ? "addsd" : "subsd", ".Lum(%rip)", destino);
+                guardar_float(ins.a, destino);
+                break;
+            }
+
+            case op_jmp:
+                emitir("jmp", ".L" + std::to_string(ins.a));
+                break;
+            case op_jz: case op_jnz: {
+                const char* salto = ins.op == op_jz ? "je" : "jne";
+                std::string destino = ".L" + std::to_string(ins.b);
+                if (eh_constante(ins.a)){
+                    if ((programa.registradores_iniciais[ins.a].i == 0) == (ins.op == op_jz)) emitir("jmp", destino);
+                } else if (em_geral(ins.a)){
+                    emitir("testq", nome(ins.a), nome(ins.a));
+                    emitir(salto, destino);
+                } else if (em_xmm(ins.a)){
+                    emitir("movq", nome(ins.a), "%rax");
+                    emitir("testq", "%rax", "%rax");
+                    emitir(salto, destino);
+                } else {
+                    emitir("cmpq", "$0", memoria(ins.a));
+                    emitir(salto, destino);
+                }
+                break;
+            }
+            case op_jlt_i: case op_jle_i: case op_jgt_i: case op_jge_i: case op_jeq_i: case op_jne_i: {
+                std::string destino = ".L" + std::to_string(ins.c);
+                if (eh_constante(ins.a) && eh_constante(ins.b)){
+                    if (comparar(ins.op, programa.registradores_iniciais[ins.a].i, programa.registradores_iniciais[ins.b].i))
+                        emitir("jmp", destino);
+                    break;
+                }
+                std::string esquerda = em_geral(ins.a) ? nome(ins.a) : "%rax";
+                carregar_int(ins.a, esquerda.c_str());
+                emitir("cmpq", fonte_int(ins.b, "%rcx"), esquerda);
+                emitir(std::string("j") + condicao(ins.op), destino);
+                break;
+            }
+
+            case op_print_i:
+                salvar_volateis();
+                carregar_int(ins.a, "%rdi");
+                emitir("call", "cmm_print_i");
+                restaurar_volateis();
+                break;
+            case op_print_f:
+                salvar_volateis();
+                carregar_float(ins.a, "%xmm0");
+                emitir("call", "cmm_print_f");
+                restaurar_volateis();
+                break;
+            case op_read_i: case op_read_f:
+                salvar_volateis();
+                passar_posicao(i, "%rdi", "%rsi");
+                emitir("call", ins.op == op_read_i ? "cmm_read_i" : "cmm_read_f");
+                restaurar_volateis();
+                if (ins.op == op_read_i) guardar_int(ins.a, "%rax");
+                else guardar_float(ins.a, "%xmm0");
+                break;
+
+            case op_ret:
+                carregar_int(ins.a, "%rax");
+                emitir("jmp", ".Lsair");
+                break;
+
+            default:
+                break;
+        }
+    }
+};
+
+// Assembly do programa inteiro; 'linhas' da a linha e a coluna dos erros de
+// execucao, que ficam fixas no codigo
+inline void escrever_assembly(CanalSaida& canal, const ProgramaBytecode& programa, IndiceLinhas& linhas){
+    GeradorNativo(programa, linhas, canal).gerar();
+}
+
+#ifndef _WIN32
+
+// roda o compilador C++ (${CXX}, ou g++) com 'argumentos'; true se ele
+// terminou sem erro (as mensagens dele saem no stderr deste processo)
+inline bool chamar_compilador(const std::vector<std::string>& argumentos){
+    const char* compilador = std::getenv("CXX");
+    if (compilador == nullptr || *compilador == '\0') compilador = "g++";
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(compilador));
+    for (const std::string& argumento : argumentos) argv.push_back(const_cast<char*>(argumento.c_str()));
+    argv.push_back(nullptr);
+
+    pid_t pid = fork();
+    if (pid == 0){
+        execvp(compilador, argv.data());
+        _exit(127);
+    }
+    int status = 0;
+    if (pid < 0 || waitpid(pid, &status, 0) < 0) return false;
+    return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+// diretorio do executavel que esta rodando, com a '/' final
+inline std::string diretorio_executavel(){
+    char caminho[PATH_MAX];
+    ssize_t tamanho = readlink("/proc/self/exe", caminho, sizeof caminho - 1);
+    if (tamanho <= 0) return "";
+    std::string diretorio(caminho, (size_t)tamanho);
+    return diretorio.substr(0, diretorio.rfind('/') + 1);
+}
+
+// Runtime ligado aos executaveis do --nativo: runtime_nativo.o no diretorio
+// do analisador, de modo que so o objeto precisa acompanhar um analisador
+// copiado. Com o fonte runtime_nativo.cpp (e os cabecalhos que ele inclui)
+// ao lado, o objeto eh compilado uma vez e refeito quando o fonte ou o
+// proprio analisador forem mais novos que ele; num diretorio sem permissao
+// de escrita o fonte eh ligado direto. Retorna "" com o motivo em 'erro' se
+// nao ha runtime
+inline std::string preparar_runtime_nativo(std::string& erro){
+    std::string diretorio = diretorio_executavel();
+    std::string objeto = diretorio + "runtime_nativo.o";
+    std::string fonte = diretorio + "runtime_nativo.cpp";
+
+    struct stat dados_objeto, dados_fonte, dados_executavel;
+    bool tem_objeto = stat(objeto.c_str(), &dados_objeto) == 0;
+    bool tem_fonte = stat(fonte.c_str(), &dados_fonte) == 0;
+    if (!tem_fonte){
+        if (tem_objeto) return objeto;
+        erro = "Runtime do --nativo nao encontrado: coloque runtime_nativo.o (g++ -std=c++17 -O2 -c runtime_nativo.cpp)"
+               " ou runtime_nativo.cpp com os seus cabecalhos em " + (diretorio.empty() ? std::string(".") : diretorio);
+        return "";
+    }
+    bool atualizado = tem_objeto && dados_objeto.st_mtime >= dados_fonte.st_mtime &&
+                      (stat("/proc/self/exe", &dados_executavel) != 0 || dados_objeto.st_mtime >= dados_executavel.st_mtime);
+    if (atualizado) return objeto;
+    if (access(diretorio.empty() ? "." : diretorio.c_str(), W_OK) != 0) return fonte;
+
+    // compila num temporario e renomeia: dois analisadores ao mesmo tempo
+    // nunca ligam um objeto pela metade
+    std::string temporario = objeto + "." + std::to_string(getpid()) + ".tmp";
+    if (!chamar_compilador({"-std=c++17", "-O2", "-c", fonte, "-o", temporario}) ||
+        std::rename(temporario.c_str(), objeto.c_str()) != 0){
+        std::remove(temporario.c_str());
+        erro = "Erro ao compilar o runtime do --nativo " + fonte + " (os cabecalhos que ele inclui, como saida.h e"
+               " vm.h, precisam estar no mesmo diretorio)";
+        return "";
+    }
+    return objeto;
+}
+
+// grava o assembly em executavel.s e o monta e liga com o runtime (o objeto
+// de preparar_runtime_nativo ou o fonte runtime_nativo.cpp); false se algo falhou
+inline bool montar_executavel(const std::string& assembly, const std::string& executavel, const std::string& runtime){
+    std::string arquivo_assembly = executavel + ".s";
+    std::ofstream arquivo(arquivo_assembly, std::ios::binary);
+    arquivo.write(assembly.data(), (std::streamsize)assembly.size());
+    arquivo.close();
+    if (!arquivo) return false;
+    return chamar_compilador({"-std=c++17", "-O2", "-o", executavel, arquivo_assembly, runtime});
+}
+
+#else
+
+inline bool chamar_compilador(const std::vector<std::string>&){ return false; }
+inline std::string preparar_runtime_nativo(std::string& erro){
+    erro = "--nativo disponivel apenas no linux";
+    return "";
+}
+inline bool montar_executavel(const std::string&, const std::string&, const std::string&){ return false; }
+
+#endif
+
+#endif
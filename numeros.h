@@ -0,0 +1,33 @@
+// Compiladores 2025.1 - Valor dos literais numericos
+//
+// Os numeros sao decodificados durante a analise e o valor vai no proprio
+// token (Token::valor), para que as fases seguintes nao precisem reler o
+// lexema. A conversao usa std::from_chars: o double eh o mais proximo do
+// decimal escrito (arredondamento correto, sem passar pelo locale como
+// strtod) e valores que nao cabem no tipo sao indicados, em vez de virarem
+// lixo, infinito ou zero em silencio.
+
+#ifndef NUMEROS_H
+#define NUMEROS_H
+
+#include <charconv>     // from_chars
+#include <cstdint>
+
+// Valor do inteiro [p, fim) (so digitos); retorna false, com valor 0, se
+// ele nao cabe em 64 bits com sinal
+inline bool decodificar_inteiro(const char* p, const char* fim, int64_t& valor){
+    if (std::from_chars(p, fim, valor).ec == std::errc()) return true;
+    valor = 0;
+    return false;
+}
+
+// Valor do float [p, fim) (digitos, '.' e digitos, talvez nenhum depois do
+// ponto); retorna false, com valor 0, se ele passa do maior double ou eh tao
+// pequeno que so poderia virar zero
+inline bool decodificar_real(const char* p, const char* fim, double& valor){
+    if (std::from_chars(p, fim, valor).ec == std::errc()) return true;
+    valor = 0;
+    return false;
+}
+
+#endif
@@ -0,0 +1,259 @@
+// Compiladores 2025.1 - Analise paralela
+//
+// Divide um arquivo grande (ja carregado em memoria) em pedacos e analisa os
+// pedacos ao mesmo tempo em um conjunto de threads. Cada pedaco comeca no
+// inicio de uma linha e fora de comentarios: como nenhum token atravessa uma
+// quebra de linha, o unico estado que passa de uma linha para outra eh estar
+// dentro de um /* comentario */, e os pontos de corte sao escolhidos por uma
+// pre-passada rapida que pula os comentarios inteiros (memchr + simd.h).
+//
+// Os tokens de cada pedaco sao guardados e emitidos na ordem original (os
+// offsets ja sao relativos ao arquivo inteiro); a saida eh identica a da
+// analise sequencial.
+
+#ifndef PARALELO_H
+#define PARALELO_H
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>          // memchr
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>           // unique_ptr
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "lexer.h"
+#include "linhas.h"
+#include "saida.h"
+
+// Conjunto fixo de threads com roubo de tarefas: cada thread tem a sua fila,
+// as tarefas enviadas sao distribuidas em rodizio e cada thread executa a
+// propria fila na ordem de chegada. Uma thread sem trabalho rouba do fim da
+// fila de outra, entao tarefas de tamanhos muito diferentes (ex.: arquivos
+// grandes e pequenos num lote) nao deixam nucleos parados
+class ConjuntoThreads {
+public:
+    explicit ConjuntoThreads(unsigned quantidade) : filas(quantidade == 0 ? 1 : quantidade) {
+        for (unsigned i = 0; i < filas.size(); i++)
+            threads.emplace_back([this, i]{ laco(i); });
+    }
+
+    ConjuntoThreads(const ConjuntoThreads&) = delete;
+    ConjuntoThreads& operator=(const ConjuntoThreads&) = delete;
+
+    ~ConjuntoThreads(){
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            encerrar = true;
+        }
+        tem_tarefa.notify_all();
+        for (std::thread& thread : threads) thread.join();
+    }
+
+    // agenda a tarefa; o future fica pronto quando ela terminar
+    std::future<void> enviar(std::function<void()> funcao){
+        std::packaged_task<void()> tarefa(std::move(funcao));
+        std::future<void> pronto = tarefa.get_future();
+        Fila& fila = filas[proxima_fila++ % filas.size()];
+        {
+            std::lock_guard<std::mutex> trava(fila.mutex);
+            fila.tarefas.push_back(std::move(tarefa));
+        }
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            pendentes++;
+        }
+        tem_tarefa.notify_one();
+        return pronto;
+    }
+
+    unsigned tamanho() const { return (unsigned)threads.size(); }
+
+private:
+    struct Fila {
+        std::mutex mutex;
+        std::deque<std::packaged_task<void()>> tarefas;
+    };
+
+    std::vector<Fila> filas;                // uma por thread
+    std::vector<std::thread> threads;
+    std::atomic<size_t> proxima_fila{0};    // rodizio do enviar
+    std::mutex mutex;
+    std::condition_variable tem_tarefa;
+    size_t pendentes = 0;                   // tarefas nas filas ainda nao reservadas
+    bool encerrar = false;
+
+    // pega uma tarefa: o inicio da propria fila ou o fim da fila de outra thread
+    bool pegar(unsigned indice, std::packaged_task<void()>& tarefa){
+        for (size_t k = 0; k < filas.size(); k++){
+            Fila& fila = filas[(indice + k) % filas.size()];
+            std::lock_guard<std::mutex> trava(fila.mutex);
+            if (fila.tarefas.empty()) continue;
+            if (k == 0){
+                tarefa = std::move(fila.tarefas.front());
+                fila.tarefas.pop_front();
+            } else {
+                tarefa = std::move(fila.tarefas.back());
+                fila.tarefas.pop_back();
+            }
+            return true;
+        }
+        return false;
+    }
+
+    void laco(unsigned indice){
+        while (true){
+            {
+                // reserva uma das tarefas pendentes (ou encerra quando nao ha mais)
+                std::unique_lock<std::mutex> trava(mutex);
+                tem_tarefa.wait(trava, [&]{ return encerrar || pendentes > 0; });
+                if (pendentes == 0) return;
+                pendentes--;
+            }
+            // a tarefa reservada esta em alguma das filas
+            std::packaged_task<void()> tarefa;
+            while (!pegar(indice, tarefa)) std::this_thread::yield();
+            tarefa();
+        }
+    }
+};
+
+// Proximo ponto de corte a partir de 'alvo': o inicio de uma linha que nao
+// esta dentro de um comentario. 'p' eh um ponto ja conhecido fora de
+// comentario (o inicio do pedaco atual), de onde a busca por "/*" comeca
+inline const char* proximo_corte(const char* p, const char* alvo, const char* fim){
+    if (alvo >= fim) return fim;
+    while (true){
+        // pula inteiros os comentarios que abrem antes do alvo
+        while (p < alvo){
+            p = (const char*)memchr(p, '/', alvo - p);
+            if (p == nullptr) break;
+            if (p + 1 < fim && p[1] == '*'){
+                Pulo pulo = rotinas_simd.pular_comentario(p + 2, fim);
+                if (!pulo.fechou) return fim;   // comentario vai ate o fim do arquivo
+                p = pulo.fim;
+                if (p > alvo) alvo = p;
+            } else {
+                p++;
+            }
+        }
+        if (alvo >= fim) return fim;
+        if (alvo[-1] == '\n') return alvo;
+
+        // o alvo esta fora de comentario: segue ate o inicio da proxima linha
+        // (e confere de novo se algum comentario abriu no caminho)
+        const char* quebra = (const char*)memchr(alvo, '\n', fim - alvo);
+        if (quebra == nullptr) return fim;
+        p = alvo;
+        alvo = quebra + 1;
+    }
+}
+
+// Resultado da analise de um pedaco
+struct PedacoLexico {
+    const char* inicio;
+    const char* fim;
+    std::vector<Token> tokens;                  // sem o EOF do pedaco
+    std::vector<Diagnostico> diagnosticos;
+    std::vector<size_t> antes_do_token;         // diagnosticos[i] vem antes de tokens[antes_do_token[i]]
+    Token eof{};                                // EOF do pedaco (so o do ultimo eh emitido)
+};
+
+inline void analisar_pedaco(const char* inicio_entrada, PedacoLexico& pedaco){
+    Lexer lexer(inicio_entrada, pedaco.inicio, pedaco.fim);
+    while (true){
+        Token token = lexer.proximo();
+        for (const Diagnostico& erro : lexer.diagnosticos){
+            pedaco.diagnosticos.push_back(erro);
+            pedaco.antes_do_token.push_back(pedaco.tokens.size());
+        }
+        lexer.diagnosticos.clear();
+        if (token.tipo == tk_eof){
+            pedaco.eof = token;
+            break;
+        }
+        pedaco.tokens.push_back(token);
+    }
+}
+
+// O limite de erros fora do ASCII (lexer.h) vale para o arquivo inteiro,
+// mas o Lexer de cada pedaco so conta os do proprio pedaco: a emissao refaz
+// a contagem na ordem do arquivo, como a analise sequencial faria
+struct LimiteCodificacao {
+    size_t erros = 0;
+
+    // false se o erro deve ser descartado; o primeiro alem do limite vira o aviso
+    bool aceitar(Diagnostico& erro){
+        if (!erro_de_codificacao(erro)) return true;
+        // o aviso de um pedaco so aparece depois de max_erros_codificacao
+        // erros do mesmo pedaco, que ja entraram nesta contagem
+        if (erros > max_erros_codificacao) return false;
+        if (erros == max_erros_codificacao) erro.categoria = erro_limite_codificacao;
+        erros++;
+        return true;
+    }
+};
+
+// Emite os tokens e diagnosticos de um pedaco
+inline void emitir_pedaco(PedacoLexico& pedaco, Saida& saida, bool ultimo, LimiteCodificacao& limite){
+    size_t proximo_erro = 0;
+    for (size_t i = 0; i <= pedaco.tokens.size(); i++){
+        while (proximo_erro < pedaco.diagnosticos.size() && pedaco.antes_do_token[proximo_erro] == i){
+            Diagnostico& erro = pedaco.diagnosticos[proximo_erro++];
+            if (limite.aceitar(erro)) saida.diagnostico(erro);
+        }
+        if (i == pedaco.tokens.size()) break;
+        saida.token(pedaco.tokens[i]);
+    }
+    if (ultimo) saida.token(pedaco.eof);
+}
+
+// Analisa [inicio, fim) em pedacos de ~tamanho_pedaco bytes usando o conjunto
+// de threads; no maximo 2 pedacos por thread ficam em memoria ao mesmo tempo
+inline void analisar_paralelo(const char* inicio, const char* fim, Saida& saida,
+                              ConjuntoThreads& threads, size_t tamanho_pedaco = 1 << 20){
+    struct EmAndamento {
+        std::unique_ptr<PedacoLexico> pedaco;
+        std::future<void> pronto;
+    };
+    std::deque<EmAndamento> fila;
+    const size_t max_em_andamento = 2 * (size_t)threads.tamanho();
+
+    const char* corte = inicio;
+    bool enviou_tudo = false;
+
+    // linhas e colunas pelo arquivo inteiro, calculadas so se a saida pedir
+    IndiceLinhas linhas(inicio, fim);
+    saida.usar_linhas(&linhas);
+    LimiteCodificacao limite;
+
+    while (true){
+        // mantem a fila cheia de pedacos sendo analisados
+        while (!enviou_tudo && fila.size() < max_em_andamento){
+            const char* alvo = (size_t)(fim - corte) > tamanho_pedaco ? corte + tamanho_pedaco : fim;
+            auto pedaco = std::make_unique<PedacoLexico>();
+            pedaco->inicio = corte;
+            pedaco->fim = proximo_corte(corte, alvo, fim);
+            corte = pedaco->fim;
+            enviou_tudo = (corte == fim);
+
+            PedacoLexico* alvo_tarefa = pedaco.get();
+            std::future<void> pronto = threads.enviar([inicio, alvo_tarefa]{ analisar_pedaco(inicio, *alvo_tarefa); });
+            fila.push_back({std::move(pedaco), std::move(pronto)});
+        }
+        if (fila.empty()) break;
+
+        // emite o pedaco mais antigo assim que ele terminar
+        EmAndamento atual = std::move(fila.front());
+        fila.pop_front();
+        atual.pronto.get();
+        bool ultimo = enviou_tudo && fila.empty();
+        emitir_pedaco(*atual.pedaco, saida, ultimo, limite);
+    }
+    saida.usar_linhas(nullptr);
+}
+
+#endif
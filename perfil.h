@@ -0,0 +1,212 @@
+// Compiladores 2025.1 - Perfil da analise (opcao --trace)
+//
+// Separa o tempo da analise em tres partes:
+//  - entrada: mapear o arquivo (tocando as paginas, para que as falhas de
+//    pagina nao caiam na classificacao) ou ler os blocos de um fluxo
+//  - classificacao: o Lexer produzindo tokens
+//  - saida: formatar os tokens e erros e grava-los
+//
+// Medir o relogio a cada token custaria quase tanto quanto o proprio token,
+// entao o Perfilador classifica um lote de tokens de uma vez, guardando-os, e
+// so depois entrega o lote a Saida (na mesma ordem, com os erros antes do
+// token que os seguiu). O relogio e os contadores so mudam entre lotes.
+//
+// No linux, os contadores de hardware (instrucoes, desvios mal previstos e
+// falhas de cache) sao lidos com perf_event_open so durante a classificacao.
+// Sem permissao (perf_event_paranoid) ou fora do linux eles ficam desligados.
+
+#ifndef PERFIL_H
+#define PERFIL_H
+
+#include <chrono>
+#include <cstdint>
+#include <cstring>      // strerror
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <cerrno>
+#include <linux/perf_event.h>   // perf_event_attr
+#include <sys/ioctl.h>          // PERF_EVENT_IOC_ENABLE / DISABLE
+#include <sys/syscall.h>        // SYS_perf_event_open
+#include <unistd.h>             // read, close
+#endif
+
+#include "lexer.h"
+#include "saida.h"
+
+// segundos desde um instante fixo qualquer
+inline double relogio(){
+    return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// le um byte de cada pagina, trazendo o arquivo mapeado para a memoria
+inline void tocar_paginas(const char* dados, size_t tamanho){
+    volatile char soma = 0;
+    for (size_t i = 0; i < tamanho; i += 4096) soma = soma + dados[i];
+}
+
+// Grupo de contadores de hardware ligados so enquanto o Lexer classifica
+class ContadoresHardware {
+public:
+    enum { instrucoes, desvios_errados, falhas_cache, total_contadores };
+
+    uint64_t valores[total_contadores] = {};
+    std::string motivo;     // por que os contadores estao indisponiveis
+
+    ContadoresHardware(){
+#ifdef __linux__
+        static const uint64_t eventos[total_contadores] = {
+            PERF_COUNT_HW_INSTRUCTIONS, PERF_COUNT_HW_BRANCH_MISSES, PERF_COUNT_HW_CACHE_MISSES
+        };
+        for (int i = 0; i < total_contadores; i++){
+            perf_event_attr atributos;
+            memset(&atributos, 0, sizeof atributos);
+            atributos.size = sizeof atributos;
+            atributos.type = PERF_TYPE_HARDWARE;
+            atributos.config = eventos[i];
+            atributos.disabled = i == 0;    // o lider liga e desliga o grupo todo
+            atributos.exclude_kernel = 1;
+            atributos.exclude_hv = 1;
+            atributos.read_format = PERF_FORMAT_GROUP;
+            int fd = (int)syscall(SYS_perf_event_open, &atributos, 0, -1, i == 0 ? -1 : descritores[0], 0);
+            if (fd < 0){
+                motivo = std::string("perf_event_open: ") + strerror(errno);
+                fechar();
+                return;
+            }
+            descritores[i] = fd;
+        }
+#else
+        motivo = "perf_event_open disponivel apenas no linux";
+#endif
+    }
+
+    ContadoresHardware(const ContadoresHardware&) = delete;
+    ContadoresHardware& operator=(const ContadoresHardware&) = delete;
+
+    ~ContadoresHardware(){ fechar(); }
+
+    bool disponiveis() const { return descritores[0] >= 0; }
+
+    void ligar(){
+#ifdef __linux__
+        if (disponiveis()) ioctl(descritores[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    void desligar(){
+#ifdef __linux__
+        if (disponiveis()) ioctl(descritores[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+#endif
+    }
+
+    // copia as contagens acumuladas para 'valores'
+    void ler(){
+#ifdef __linux__
+        if (!disponiveis()) return;
+        uint64_t grupo[1 + total_contadores];   // quantidade de eventos e os valores
+        if (read(descritores[0], grupo, sizeof grupo) != (ssize_t)sizeof grupo) return;
+        for (int i = 0; i < total_contadores; i++) valores[i] = grupo[1 + i];
+#endif
+    }
+
+private:
+    int descritores[total_contadores] = {-1, -1, -1};
+
+    void fechar(){
+#ifdef __linux__
+        for (int& fd : descritores){
+            if (fd >= 0) close(fd);
+            fd = -1;
+        }
+#endif
+    }
+};
+
+class Perfilador {
+public:
+    static constexpr size_t tamanho_lote = 4096;
+
+    double tempo_entrada = 0;
+    double tempo_classificacao = 0;
+    double tempo_saida = 0;
+    ContadoresHardware contadores;
+
+    // Analisa ate o EOF (retorna false) ou ate o Lexer parar esperando o
+    // proximo bloco de um fluxo (retorna true), entregando tudo a saida
+    bool analisar(Lexer& lexer, Saida& saida){
+        lote.reserve(tamanho_lote);
+        fim_erros.reserve(tamanho_lote);
+        while (true){
+            lote.clear();
+            fim_erros.clear();
+            bool terminou = false, esperando = false;
+
+            double inicio = relogio();
+            contadores.ligar();
+            while (lote.size() < tamanho_lote){
+                Token token = lexer.proximo();
+                if (token.tipo == tk_eof && lexer.aguardando_dados()){
+                    esperando = true;
+                    break;
+                }
+                lote.push_back(token);
+                fim_erros.push_back(lexer.diagnosticos.size());
+                if (token.tipo == tk_eof){
+                    terminou = true;
+                    break;
+                }
+            }
+            contadores.desligar();
+            double meio = relogio();
+
+            size_t erro = 0;
+            for (size_t i = 0; i < lote.size(); i++){
+                for (; erro < fim_erros[i]; erro++) saida.diagnostico(lexer.diagnosticos[erro]);
+                saida.token(lote[i]);
+            }
+            for (; erro < lexer.diagnosticos.size(); erro++) saida.diagnostico(lexer.diagnosticos[erro]);
+            lexer.diagnosticos.clear();
+
+            tempo_classificacao += meio - inicio;
+            tempo_saida += relogio() - meio;
+            if (terminou) return false;
+            if (esperando) return true;
+        }
+    }
+
+private:
+    std::vector<Token> lote;
+    std::vector<size_t> fim_erros;  // erros a entregar antes de cada token do lote
+};
+
+// Tempos e contadores, uma medida por linha
+inline void escrever_perfil(CanalSaida& canal, Perfilador& perfil){
+    static const char* nomes_tempos[] = {"entrada", "classificacao", "saida"};
+    const double tempos[] = {perfil.tempo_entrada, perfil.tempo_classificacao, perfil.tempo_saida};
+    for (int i = 0; i < 3; i++){
+        canal.escrever("tempo ");
+        canal.escrever(nomes_tempos[i]);
+        canal.escrever(": ");
+        canal.escrever_numero((int64_t)(tempos[i] * 1e6));
+        canal.escrever(" us\n");
+    }
+
+    if (!perfil.contadores.disponiveis()){
+        canal.escrever("contadores de hardware indisponiveis (");
+        canal.escrever(perfil.contadores.motivo);
+        canal.escrever(")\n");
+        return;
+    }
+    static const char* nomes_contadores[] = {"instrucoes", "desvios mal previstos", "falhas de cache"};
+    perfil.contadores.ler();
+    for (int i = 0; i < ContadoresHardware::total_contadores; i++){
+        canal.escrever(nomes_contadores[i]);
+        canal.escrever(": ");
+        canal.escrever_numero((int64_t)perfil.contadores.valores[i]);
+        canal.escrever("\n");
+    }
+}
+
+#endif
@@ -0,0 +1,292 @@
+// Compiladores 2025.1 - Analisador Lexico de referencia
+//
+// O analisador original do lexico.cpp (um caractere por vez, classes por
+// cadeias de if, palavras reservadas numa lista de strings), congelado e
+// adaptado so para entregar os tokens e erros atuais: Token e Diagnostico
+// de lexer.h, com offset, valor e as categorias de erro de hoje.
+//
+// Ele nao usa nada do que o Lexer usa: nem as tabelas de tabelas.h
+// (classes, transicoes, operadores, hash das palavras reservadas), nem
+// numeros.h, nem utf8.h. Assim um erro numa dessas pecas aparece como
+// divergencia no benchmark --diferencial, em vez de ser reproduzido dos dois
+// lados. Nao eh feito para ser rapido.
+
+#ifndef REFERENCIA_H
+#define REFERENCIA_H
+
+#include <cerrno>
+#include <cmath>            // isinf
+#include <cstdint>
+#include <cstdlib>          // strtod
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "lexer.h"          // Token, Diagnostico, tipos_token, categorias_erro
+
+class LexerReferencia {
+public:
+    std::vector<Diagnostico> diagnosticos;  // erros encontrados ate agora
+    size_t limite_erros_codificacao = max_erros_codificacao;
+
+    LexerReferencia(const char* inicio, const char* fim) : inicio_entrada(inicio), p(inicio), fim(fim) {}
+
+    // devolve o proximo token; depois do fim da entrada devolve sempre tk_eof
+    Token proximo(){
+        Estado estado_atual = Estado::inicio;
+        const char* inicio_lexema = p;
+
+        while (true){
+            int c = p < fim ? (unsigned char)*p : fim_da_entrada;
+            Classe classe = classificar_caractere(c);
+
+            switch (estado_atual){
+                case Estado::inicio:
+                    inicio_lexema = p;
+                    if (classe == Classe::letra || classe == Classe::underline){
+                        estado_atual = Estado::id;
+                        p++;
+                    }
+                    else if (classe == Classe::digito){
+                        estado_atual = Estado::numero;
+                        p++;
+                    }
+                    else if (classe == Classe::barra){
+                        estado_atual = Estado::barra;
+                        p++;
+                    }
+                    else if (classe == Classe::operador || classe == Classe::delimitador){
+                        p++;
+                        if (Token token; operador(inicio_lexema, token)) return token;
+                    }
+                    else if (classe == Classe::espaco_em_branco){
+                        p++;
+                    }
+                    else if (classe == Classe::fim_do_arquivo){
+                        return criar_token(tk_eof, inicio_lexema);
+                    }
+                    else if (c < 0x80){
+                        // '.' sem digitos antes tambem eh invalido
+                        p++;
+                        reportar(erro_caractere_invalido, inicio_lexema, 1);
+                    }
+                    else {
+                        fora_do_ascii();
+                    }
+                    break;
+
+                case Estado::id:
+                    if (classe == Classe::letra || classe == Classe::digito || classe == Classe::underline){
+                        p++;
+                    } else {
+                        std::string lexema(inicio_lexema, p);
+                        for (size_t i = 0; i < palavras_reservadas.size(); i++)
+                            if (lexema == palavras_reservadas[i]) return criar_token((tipos_token)(tk_if + i), inicio_lexema);
+                        return criar_token(tk_id, inicio_lexema);
+                    }
+                    break;
+
+                case Estado::numero:
+                    if (classe == Classe::digito){
+                        p++;
+                    }
+                    else if (classe == Classe::ponto){
+                        estado_atual = Estado::decimal;
+                        p++;
+                    }
+                    else {
+                        return inteiro(inicio_lexema);
+                    }
+                    break;
+
+                case Estado::decimal:
+                    if (classe == Classe::digito) p++;
+                    else return real(inicio_lexema);
+                    break;
+
+                case Estado::barra:
+                    if (c != '*') return criar_token(tk_div, inicio_lexema);
+                    // comentario: vai ate o "*/" ou ate o fim, sem erro
+                    p++;
+                    while (p < fim){
+                        char anterior = *p++;
+                        if (anterior == '*' && p < fim && *p == '/'){
+                            p++;
+                            break;
+                        }
+                    }
+                    estado_atual = Estado::inicio;
+                    break;
+            }
+        }
+    }
+
+private:
+    enum class Classe { letra, digito, underline, ponto, operador, delimitador, espaco_em_branco, barra,
+                        fim_do_arquivo, invalido };
+    enum class Estado { inicio, id, numero, decimal, barra };
+
+    static constexpr int fim_da_entrada = -1;
+
+    // Lista de palavras reservadas da linguagem, na ordem de tipos_token
+    inline static const std::vector<std::string> palavras_reservadas = {
+        "if", "else", "while", "break", "print", "readln", "return", "int", "float", "char", "bool", "true", "false"
+    };
+
+    const char* inicio_entrada;
+    const char* p;
+    const char* fim;
+    size_t erros_codificacao = 0;
+
+    // Classifica o caractere (so ASCII: isalpha e companhia dependeriam do locale)
+    static Classe classificar_caractere(int c){
+        if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) return Classe::letra;
+        if (c >= '0' && c <= '9') return Classe::digito;
+        if (c == '_') return Classe::underline;
+        if (c == '.') return Classe::ponto;
+        if (c == '+' || c == '-' || c == '*' || c == '=' || c == '!' || c == '<' || c == '>' || c == '&' || c == '|')
+            return Classe::operador;
+        if (c == '(' || c == ')' || c == '{' || c == '}' || c == ';' || c == ',' || c == '%') return Classe::delimitador;
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\v' || c == '\f') return Classe::espaco_em_branco;
+        if (c == '/') return Classe::barra;
+        if (c == fim_da_entrada) return Classe::fim_do_arquivo;
+        return Classe::invalido;
+    }
+
+    // operador ou delimitador que comeca em inicio_lexema (ja consumido);
+    // false se eh um '&' ou '|' sozinho, que so gera erro
+    bool operador(const char* inicio_lexema, Token& token){
+        std::string lexema(1, *inicio_lexema);
+        if (p < fim){
+            std::string op_composto = lexema + *p;
+            if (op_composto == "==" || op_composto == "<=" || op_composto == ">=" || op_composto == "!=" ||
+                op_composto == "&&" || op_composto == "||" || op_composto == "++" || op_composto == "--"){
+                lexema = op_composto;
+                p++;
+            }
+        }
+
+        tipos_token tipo;
+        if (lexema == "==") tipo = tk_eq;
+        else if (lexema == "!=") tipo = tk_diff;
+        else if (lexema == "<=") tipo = tk_leq;
+        else if (lexema == ">=") tipo = tk_geq;
+        else if (lexema == "&&") tipo = tk_and;
+        else if (lexema == "||") tipo = tk_or;
+        else if (lexema == "++") tipo = tk_increment;
+        else if (lexema == "--") tipo = tk_decrement;
+        else if (lexema == "+") tipo = tk_plus;
+        else if (lexema == "-") tipo = tk_minus;
+        else if (lexema == "*") tipo = tk_mult;
+        else if (lexema == "=") tipo = tk_assign;
+        else if (lexema == "<") tipo = tk_lt;
+        else if (lexema == ">") tipo = tk_gt;
+        else if (lexema == "!") tipo = tk_neg;
+        else if (lexema == "(") tipo = tk_lparent;
+        else if (lexema == ")") tipo = tk_rparent;
+        else if (lexema == "{") tipo = tk_lbrace;
+        else if (lexema == "}") tipo = tk_rbrace;
+        else if (lexema == ";") tipo = tk_semicolon;
+        else if (lexema == ",") tipo = tk_comma;
+        else if (lexema == "%") tipo = tk_mod;
+        else {
+            reportar(erro_operador_incompleto, inicio_lexema, 1);
+            return false;
+        }
+        token = criar_token(tipo, inicio_lexema);
+        return true;
+    }
+
+    // Numeros inteiros: o valor eh acumulado digito a digito
+    Token inteiro(const char* inicio_lexema){
+        std::string lexema(inicio_lexema, p);
+        if (lexema.length() > 1 && lexema[0] == '0')
+            reportar(erro_zero_esquerda_int, inicio_lexema, lexema.length());
+
+        Token token = criar_token(tk_num_int, inicio_lexema);
+        uint64_t valor = 0;
+        bool cabe = true;
+        for (char digito : lexema){
+            if (valor > (UINT64_C(9223372036854775807) - (uint64_t)(digito - '0')) / 10){
+                cabe = false;
+                break;
+            }
+            valor = valor * 10 + (uint64_t)(digito - '0');
+        }
+        if (cabe) token.valor.inteiro = (int64_t)valor;
+        else reportar(erro_inteiro_fora_do_limite, inicio_lexema, lexema.length());
+        return token;
+    }
+
+    // Numeros com ponto decimal: o valor vem de strtod (o programa nao muda
+    // o locale, entao o ponto eh sempre '.')
+    Token real(const char* inicio_lexema){
+        std::string lexema(inicio_lexema, p);
+        size_t pos_ponto = lexema.find('.');
+        std::string parte_inteira = lexema.substr(0, pos_ponto);
+        std::string parte_fracionaria = lexema.substr(pos_ponto + 1);
+
+        if (parte_inteira.length() > 1 && parte_inteira[0] == '0')
+            reportar(erro_zero_esquerda_float, inicio_lexema, lexema.length());
+        if (parte_fracionaria.empty())
+            reportar(erro_fracao_ausente, inicio_lexema, lexema.length());
+
+        Token token = criar_token(tk_num_float, inicio_lexema);
+        double valor = std::strtod(lexema.c_str(), nullptr);
+        // fora do limite: passa do maior double ou vira zero sem o numero ser zero
+        bool zero_escrito = lexema.find_first_of("123456789") == std::string::npos;
+        if (std::isinf(valor) || (valor == 0 && !zero_escrito))
+            reportar(erro_float_fora_do_limite, inicio_lexema, lexema.length());
+        else
+            token.valor.real = valor;
+        return token;
+    }
+
+    // Caractere fora do ASCII em p: um erro por caractere UTF-8, ou por
+    // trecho invalido (o maior prefixo que ainda poderia formar um
+    // caractere). Passado o limite vem o aviso, e depois os bytes fora do
+    // ASCII sao pulados sem erro
+    void fora_do_ascii(){
+        const char* inicio_lexema = p;
+        if (erros_codificacao > limite_erros_codificacao){
+            while (p < fim && (unsigned char)*p >= 0x80) p++;
+            return;
+        }
+
+        unsigned char primeiro = (unsigned char)*p++;
+        size_t continuacoes = primeiro >= 0xf0 ? 3 : primeiro >= 0xe0 ? 2 : 1;
+        bool valido = primeiro >= 0xc2 && primeiro <= 0xf4;
+        uint32_t codigo = primeiro & (0x3f >> continuacoes);
+        for (size_t i = 0; valido && i < continuacoes; i++){
+            if (p == fim || ((unsigned char)*p & 0xc0) != 0x80){
+                valido = false;
+                break;
+            }
+            uint32_t parcial = (codigo << 6) | ((unsigned char)*p & 0x3f);
+            // o primeiro byte de continuacao ja decide sobrelongas, surrogates e > U+10FFFF
+            // (os bits ja lidos: abaixo de U+0800 ou U+10000, D800..DFFF, acima de U+10FFFF)
+            if (i == 0 && ((continuacoes == 2 && (parcial < 0x20 || (parcial >= 0x360 && parcial <= 0x37f))) ||
+                           (continuacoes == 3 && (parcial < 0x10 || parcial > 0x10f)))){
+                valido = false;
+                break;
+            }
+            codigo = parcial;
+            p++;
+        }
+
+        categorias_erro categoria = valido ? erro_caractere_invalido : erro_utf8_invalido;
+        if (erros_codificacao == limite_erros_codificacao) categoria = erro_limite_codificacao;
+        reportar(categoria, inicio_lexema, (size_t)(p - inicio_lexema));
+        erros_codificacao++;
+    }
+
+    Token criar_token(tipos_token tipo, const char* inicio_lexema) const {
+        return {tipo, std::string_view(inicio_lexema, p - inicio_lexema), (size_t)(inicio_lexema - inicio_entrada)};
+    }
+
+    void reportar(categorias_erro categoria, const char* inicio_lexema, size_t tamanho){
+        diagnosticos.push_back({categoria, std::string_view(inicio_lexema, tamanho), (size_t)(inicio_lexema - inicio_entrada)});
+    }
+};
+
+#endif
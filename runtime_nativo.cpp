@@ -0,0 +1,84 @@
+// Compiladores 2025.1 - Runtime dos programas C-- compilados para x86-64
+
+// Ligado ao assembly gerado por nativo.h; compilado uma vez para um objeto
+// no diretorio do analisador:
+//   g++ -std=c++17 -O2 -c runtime_nativo.cpp
+// e entao ./analisador --nativo=programa arquivo.txt monta programa.s e o
+// liga com runtime_nativo.o (g++ -o programa programa.s runtime_nativo.o).
+// Um analisador copiado para outro lugar so precisa levar runtime_nativo.o;
+// sem o objeto, ele eh compilado deste arquivo (com os cabecalhos abaixo) no
+// primeiro --nativo.
+//
+// O main chama o programa (cmm_programa) e devolve o valor do return como
+// codigo de saida. print, readln e os erros de execucao passam pelas mesmas
+// rotinas do --executar (CanalSaida de saida.h, cin, formatar_erro_execucao
+// de vm.h), entao a saida eh identica a da maquina virtual.
+
+#include <iostream>     // cin
+#include <cstdint>
+#include <cstdlib>      // exit
+
+#include "saida.h"      // CanalSaida
+#include "vm.h"         // formatar_erro_execucao
+#include "nativo.h"     // mensagens_erros_nativos
+
+using namespace std;
+
+// stdout com buffer, descarregado antes de cada readln e no fim
+static CanalSaida& canal_saida(){
+    static CanalSaida canal(1);
+    return canal;
+}
+
+extern "C" {
+
+int64_t cmm_programa();
+
+void cmm_print_i(int64_t valor){
+    CanalSaida& saida = canal_saida();
+    saida.escrever_numero(valor);
+    saida.escrever("\n");
+    saida.verificar();
+}
+
+void cmm_print_f(double valor){
+    CanalSaida& saida = canal_saida();
+    saida.escrever_real(valor);
+    saida.escrever("\n");
+    saida.verificar();
+}
+
+// "Encontrado ERRO DE EXECUCAO na linha L, coluna C: ..." e termina com 1
+[[noreturn]] void cmm_falhar(int64_t erro, int64_t linha, int64_t coluna){
+    canal_saida().descarregar();
+    CanalSaida canal_erros(2);
+    ResultadoExecucao resultado;
+    resultado.ok = false;
+    resultado.erro = mensagens_erros_nativos[erro];
+    formatar_erro_execucao(canal_erros, resultado, PosicaoTexto{(int)linha, (int)coluna}, canal_erros.interativo);
+    canal_erros.descarregar();
+    exit(1);
+}
+
+// o que ja foi impresso aparece antes de o programa esperar a entrada
+int64_t cmm_read_i(int64_t linha, int64_t coluna){
+    canal_saida().descarregar();
+    int64_t valor;
+    if (!(cin >> valor)) cmm_falhar(nativo_leitura_int, linha, coluna);
+    return valor;
+}
+
+double cmm_read_f(int64_t linha, int64_t coluna){
+    canal_saida().descarregar();
+    double valor;
+    if (!(cin >> valor)) cmm_falhar(nativo_leitura_float, linha, coluna);
+    return valor;
+}
+
+}
+
+int main(){
+    int64_t codigo = cmm_programa();
+    canal_saida().descarregar();
+    return (int)(codigo & 0xff);
+}
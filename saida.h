@@ -0,0 +1,531 @@
+// Compiladores 2025.1 - Saida do Analisador Lexico
+//
+// Camada de saida dos tokens e diagnosticos. Cada formato (texto, JSON Lines
+// e binario) eh uma Saida que formata direto em buffers grandes (CanalSaida)
+// pertencentes a thread que analisa; os buffers sao escritos no descritor com
+// poucas chamadas write() grandes, sem passar por cout/cerr.
+//
+// Opcionalmente o CanalSaida tem uma thread escritora: os blocos cheios
+// entram numa fila limitada e a thread que analisa continua formatando em
+// outro bloco enquanto o anterior eh gravado.
+
+#ifndef SAIDA_H
+#define SAIDA_H
+
+#include <algorithm>            // min
+#include <charconv>             // to_chars
+#include <condition_variable>
+#include <deque>
+#include <memory>               // unique_ptr
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>                 // _write, _isatty
+#else
+#include <unistd.h>             // write, isatty
+#endif
+#include <cerrno>
+
+#include "lexer.h"
+#include "linhas.h"             // linha e coluna a partir do offset
+#include "formato_binario.h"
+
+// Formatos de saida dos tokens
+enum formatos_saida { formato_texto, formato_jsonl, formato_bin };
+
+// Nome de cada categoria de erro (na ordem de categorias_erro), usado no JSON
+constexpr const char* nomes_erros[total_categorias_erro] = {
+    "zero_esquerda_int", "zero_esquerda_float", "fracao_ausente",
+    "caractere_invalido", "operador_incompleto", "inteiro_fora_do_limite", "float_fora_do_limite",
+    "utf8_invalido", "limite_codificacao"
+};
+
+// Escreve todos os bytes no descritor, repetindo em escritas parciais
+inline void escrever_tudo(int fd, const char* dados, size_t tamanho){
+    while (tamanho > 0){
+#ifdef _WIN32
+        int escritos = _write(fd, dados, (unsigned)std::min<size_t>(tamanho, 1u << 30));
+#else
+        ssize_t escritos = write(fd, dados, tamanho);
+#endif
+        if (escritos < 0){
+            if (errno == EINTR) continue;
+            return;     // saida fechada (ex.: pipe encerrado): descarta o resto
+        }
+        dados += escritos;
+        tamanho -= (size_t)escritos;
+    }
+}
+
+inline bool eh_terminal(int fd){
+#ifdef _WIN32
+    return _isatty(fd) != 0;
+#else
+    return isatty(fd) != 0;
+#endif
+}
+
+// Buffer de saida ligado a um descritor (1 = stdout, 2 = stderr)
+class CanalSaida {
+public:
+    static constexpr size_t tamanho_bloco = 1 << 20;
+    static constexpr size_t max_blocos_pendentes = 8;   // limita a memoria da fila
+
+    std::string buffer;     // os formatadores escrevem direto aqui
+    bool interativo;        // o descritor eh um terminal
+
+    // com 'assincrono' os blocos cheios sao gravados por uma thread separada
+    // (ignorado em terminais, onde a ordem entre stdout e stderr importa)
+    explicit CanalSaida(int fd, bool assincrono = false)
+        : interativo(eh_terminal(fd)), fd(fd) {
+        buffer.reserve(tamanho_bloco);
+        if (assincrono && !interativo)
+            escritor = std::thread(&CanalSaida::laco_escritor, this);
+    }
+
+    // canal em memoria: nada eh gravado, quem criou o canal le o buffer
+    // (usado para guardar a saida de cada arquivo no modo em lote)
+    CanalSaida() : interativo(false), fd(-1) {}
+
+    CanalSaida(const CanalSaida&) = delete;
+    CanalSaida& operator=(const CanalSaida&) = delete;
+
+    ~CanalSaida(){
+        descarregar();
+        if (escritor.joinable()){
+            {
+                std::lock_guard<std::mutex> trava(mutex);
+                encerrar = true;
+            }
+            tem_bloco.notify_one();
+            escritor.join();
+        }
+    }
+
+    void escrever(std::string_view texto){
+        buffer.append(texto.data(), texto.size());
+    }
+
+    void escrever_numero(int64_t valor){
+        char digitos[24];
+        auto resultado = std::to_chars(digitos, digitos + sizeof(digitos), valor);
+        buffer.append(digitos, resultado.ptr);
+    }
+
+    // menor texto que le de volta o mesmo double
+    void escrever_real(double valor){
+        char digitos[32];
+        auto resultado = std::to_chars(digitos, digitos + sizeof(digitos), valor);
+        buffer.append(digitos, resultado.ptr);
+    }
+
+    // chamado apos cada registro: so grava quando o bloco encheu
+    void verificar(){
+        if (buffer.size() >= tamanho_bloco && fd >= 0) descarregar();
+    }
+
+    // grava (ou entrega a thread escritora) tudo o que estiver no buffer
+    void descarregar(){
+        if (buffer.empty() || fd < 0) return;
+        if (!escritor.joinable()){
+            escrever_tudo(fd, buffer.data(), buffer.size());
+            buffer.clear();
+            return;
+        }
+
+        std::unique_lock<std::mutex> trava(mutex);
+        tem_espaco.wait(trava, [&]{ return pendentes.size() < max_blocos_pendentes; });
+        pendentes.push_back(std::move(buffer));
+        buffer.clear();
+        if (!livres.empty()){
+            buffer = std::move(livres.back());  // reaproveita um bloco ja gravado
+            livres.pop_back();
+        }
+        trava.unlock();
+        tem_bloco.notify_one();
+        buffer.reserve(tamanho_bloco);
+    }
+
+private:
+    int fd;
+    std::thread escritor;
+    std::mutex mutex;
+    std::condition_variable tem_bloco;      // avisa a thread escritora
+    std::condition_variable tem_espaco;     // avisa quem esta esperando a fila andar
+    std::deque<std::string> pendentes;      // blocos cheios a gravar
+    std::vector<std::string> livres;        // blocos gravados, prontos para reuso
+    bool encerrar = false;
+
+    void laco_escritor(){
+        std::unique_lock<std::mutex> trava(mutex);
+        while (true){
+            tem_bloco.wait(trava, [&]{ return !pendentes.empty() || encerrar; });
+            if (pendentes.empty()) return;
+
+            std::string bloco = std::move(pendentes.front());
+            pendentes.pop_front();
+            trava.unlock();
+            tem_espaco.notify_one();
+
+            escrever_tudo(fd, bloco.data(), bloco.size());
+            bloco.clear();
+
+            trava.lock();
+            livres.push_back(std::move(bloco));
+        }
+    }
+};
+
+// Formata um erro lexico como texto, com a linha e a coluna
+// (em vermelho apenas quando 'cor', ou seja, quando stderr eh um terminal)
+// e, se houver, o arquivo de origem na frente
+inline void formatar_diagnostico(CanalSaida& canal, const Diagnostico& erro, PosicaoTexto posicao, bool cor,
+                                 std::string_view origem = {}){
+    if (cor) canal.escrever("\033[31m");
+    if (!origem.empty()){
+        canal.escrever(origem);
+        canal.escrever(": ");
+    }
+    canal.escrever("Encontrado ERRO na linha ");
+    canal.escrever_numero(posicao.linha);
+    canal.escrever(", coluna ");
+    canal.escrever_numero(posicao.coluna);
+    switch (erro.categoria){
+        case erro_zero_esquerda_int:
+            canal.escrever(": zero à esquerda em número inteiro '");
+            canal.escrever(erro.lexema);
+            canal.escrever("'");
+            break;
+        case erro_zero_esquerda_float:
+            canal.escrever(": zero à esquerda em número float '");
+            canal.escrever(erro.lexema);
+            canal.escrever("'");
+            break;
+        case erro_fracao_ausente:
+            canal.escrever(": parte fracionária faltando após ponto decimal");
+            break;
+        case erro_operador_incompleto:
+            canal.escrever(": operador '");
+            canal.escrever(erro.lexema);
+            canal.escrever("' incompleto ou inválido");
+            break;
+        case erro_inteiro_fora_do_limite:
+            canal.escrever(": número inteiro não cabe em 64 bits '");
+            canal.escrever(erro.lexema);
+            canal.escrever("'");
+            break;
+        case erro_float_fora_do_limite:
+            canal.escrever(": número float fora do intervalo de double '");
+            canal.escrever(erro.lexema);
+            canal.escrever("'");
+            break;
+        // os bytes saem em hexadecimal: copiados crus estragariam o terminal
+        case erro_utf8_invalido: {
+            static const char hexa[] = "0123456789ABCDEF";
+            canal.escrever(": sequência UTF-8 inválida");
+            for (char c : erro.lexema){
+                char byte[5] = {' ', '0', 'x', hexa[(unsigned char)c >> 4], hexa[(unsigned char)c & 0xf]};
+                canal.escrever(std::string_view(byte, 5));
+            }
+            break;
+        }
+        case erro_limite_codificacao:
+            canal.escrever(": muitos caracteres fora do ASCII (o arquivo está em UTF-8?); os próximos foram omitidos");
+            break;
+        default:
+            canal.escrever(": caractere inválido '");
+            canal.escrever(erro.lexema);
+            canal.escrever("'");
+            break;
+    }
+    if (cor) canal.escrever("\033[0m");
+    canal.escrever("\n");
+}
+
+// Destino dos tokens e diagnosticos produzidos pelo Lexer
+class Saida {
+public:
+    virtual ~Saida() = default;
+    virtual void token(const Token& token) = 0;
+    virtual void diagnostico(const Diagnostico& erro) = 0;
+
+    // indice do texto que esta sendo analisado, para as linhas e colunas
+    // (definido por quem chama o Lexer; sem ele as posicoes saem 0)
+    virtual void usar_linhas(IndiceLinhas* indice){ linhas = indice; }
+
+    std::string origem;             // arquivo prefixado as mensagens de erro (modo em lote)
+    size_t total_diagnosticos = 0;  // erros escritos ate agora
+
+protected:
+    IndiceLinhas* linhas = nullptr;
+
+    PosicaoTexto posicao(size_t offset){
+        return linhas != nullptr ? linhas->posicao(offset) : PosicaoTexto{0, 0};
+    }
+
+    // os erros sempre aparecem como texto em stderr, qualquer que seja o formato
+    void diagnostico_texto(CanalSaida& tokens, CanalSaida& erros, const Diagnostico& erro){
+        total_diagnosticos++;
+        // com os dois no terminal o erro aparece junto dos tokens ja impressos
+        if (erros.interativo && tokens.interativo) tokens.descarregar();
+        formatar_diagnostico(erros, erro, posicao(erro.offset), erros.interativo, origem);
+        if (erros.interativo) erros.descarregar();
+        else erros.verificar();
+    }
+};
+
+// Uma linha por token: ID.x, NUM.10, SEMICOLON, ...
+class SaidaTexto : public Saida {
+public:
+    SaidaTexto(CanalSaida& tokens, CanalSaida& erros) : tokens(tokens), erros(erros) {}
+
+    void token(const Token& token) override {
+        switch (token.tipo){
+            case tk_id:
+                tokens.escrever("ID.");
+                tokens.escrever(token.lexema);
+                break;
+            case tk_num_int:
+            case tk_num_float:
+                tokens.escrever("NUM.");
+                tokens.escrever(token.lexema);
+                break;
+            default:
+                tokens.escrever(nomes_tokens[token.tipo]);
+                break;
+        }
+        tokens.escrever("\n");
+        tokens.verificar();
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        diagnostico_texto(tokens, erros, erro);
+    }
+
+private:
+    CanalSaida& tokens;
+    CanalSaida& erros;
+};
+
+// Um objeto JSON por linha, para tokens e erros (numeros levam o valor):
+//   {"tipo":"ID","lexema":"x","offset":4,"linha":1,"coluna":5}
+//   {"tipo":"NUM","lexema":"2.50","valor":2.5,"offset":8,"linha":1,"coluna":9}
+//   {"erro":"caractere_invalido","lexema":"@","offset":9,"linha":2,"coluna":3}
+class SaidaJsonl : public Saida {
+public:
+    SaidaJsonl(CanalSaida& tokens, CanalSaida& erros) : tokens(tokens), erros(erros) {}
+
+    void token(const Token& token) override {
+        tokens.escrever("{\"tipo\":\"");
+        tokens.escrever(nomes_tokens[token.tipo]);
+        tokens.escrever("\",\"lexema\":\"");
+        escrever_string_json(token.lexema);
+        tokens.escrever("\",");
+        if (token.tipo == tk_num_int){
+            tokens.escrever("\"valor\":");
+            tokens.escrever_numero(token.valor.inteiro);
+            tokens.escrever(",");
+        } else if (token.tipo == tk_num_float){
+            tokens.escrever("\"valor\":");
+            tokens.escrever_real(token.valor.real);
+            tokens.escrever(",");
+        }
+        escrever_posicao(token.offset);
+        tokens.verificar();
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        tokens.escrever("{\"erro\":\"");
+        tokens.escrever(nomes_erros[erro.categoria]);
+        tokens.escrever("\",\"lexema\":\"");
+        escrever_string_json(erro.lexema);
+        tokens.escrever("\",");
+        escrever_posicao(erro.offset);
+        tokens.verificar();
+        diagnostico_texto(tokens, erros, erro);
+    }
+
+private:
+    CanalSaida& tokens;
+    CanalSaida& erros;
+
+    void escrever_posicao(size_t offset){
+        PosicaoTexto linha_coluna = posicao(offset);
+        tokens.escrever("\"offset\":");
+        tokens.escrever_numero((int64_t)offset);
+        tokens.escrever(",\"linha\":");
+        tokens.escrever_numero(linha_coluna.linha);
+        tokens.escrever(",\"coluna\":");
+        tokens.escrever_numero(linha_coluna.coluna);
+        tokens.escrever("}\n");
+    }
+
+    // escapa aspas, barras e bytes de controle (\u00XX); caracteres UTF-8
+    // validos vao como estao (JSON eh UTF-8) e os bytes de uma sequencia
+    // invalida sao escapados um a um, como se fossem Latin-1
+    void escrever_string_json(std::string_view texto){
+        static const char hexa[] = "0123456789abcdef";
+        for (size_t i = 0; i < texto.size(); i++){
+            char c = texto[i];
+            unsigned char byte = (unsigned char)c;
+            if (byte >= 0x80){
+                SequenciaUtf8 caractere = decodificar_utf8(texto.data() + i, texto.data() + texto.size());
+                if (caractere.valida){
+                    tokens.buffer.append(texto.data() + i, caractere.tamanho);
+                    i += caractere.tamanho - 1;
+                    continue;
+                }
+            }
+            if (byte == '"' || byte == '\\'){
+                tokens.buffer.push_back('\\');
+                tokens.buffer.push_back(c);
+            } else if (byte < 0x20 || byte >= 0x7f){
+                char escape[6] = {'\\', 'u', '0', '0', hexa[byte >> 4], hexa[byte & 0xf]};
+                tokens.buffer.append(escape, 6);
+            } else {
+                tokens.buffer.push_back(c);
+            }
+        }
+    }
+};
+
+// Formato binario de formato_binario.h, gravado direto no buffer do canal
+class SaidaBinaria : public Saida {
+public:
+    SaidaBinaria(CanalSaida& tokens, CanalSaida& erros, uint8_t flags)
+        : tokens(tokens), erros(erros), escritor(tokens.buffer, flags) {}
+
+    void token(const Token& token) override {
+        escritor.escrever(token);
+        tokens.verificar();
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        escritor.escrever(erro);
+        tokens.verificar();
+        diagnostico_texto(tokens, erros, erro);
+    }
+
+private:
+    CanalSaida& tokens;
+    CanalSaida& erros;
+    EscritorBinario escritor;
+};
+
+// Contagens da analise (opcao --stats)
+struct EstatisticasLexicas {
+    size_t tokens = 0;              // sem contar o EOF
+    size_t identificadores = 0;
+    size_t diagnosticos = 0;
+    size_t bytes = 0;
+    size_t linhas = 0;              // quebras de linha, como no wc -l
+    size_t por_tipo[total_tokens] = {};
+    size_t por_categoria[total_categorias_erro] = {};
+    TabelaSimbolos simbolos;        // identificadores distintos
+
+    // soma as contagens de outra analise (ex.: outro arquivo do lote)
+    void acumular(const EstatisticasLexicas& outra){
+        tokens += outra.tokens;
+        identificadores += outra.identificadores;
+        diagnosticos += outra.diagnosticos;
+        bytes += outra.bytes;
+        linhas += outra.linhas;
+        for (int tipo = 0; tipo < total_tokens; tipo++) por_tipo[tipo] += outra.por_tipo[tipo];
+        for (int categoria = 0; categoria < total_categorias_erro; categoria++)
+            por_categoria[categoria] += outra.por_categoria[categoria];
+        for (uint32_t id = 0; id < outra.simbolos.tamanho(); id++)
+            simbolos.internar(outra.simbolos.nome(id));
+    }
+};
+
+// Repassa tokens e erros para outra Saida, contando-os no caminho. Os IDs
+// que ja vem com o id da tabela (Lexer com simbolos = &estatisticas.simbolos)
+// nao sao internados de novo
+class SaidaEstatisticas : public Saida {
+public:
+    SaidaEstatisticas(Saida& destino, EstatisticasLexicas& estatisticas)
+        : destino(destino), estatisticas(estatisticas) {}
+
+    void usar_linhas(IndiceLinhas* indice) override {
+        linhas = indice;
+        destino.usar_linhas(indice);
+    }
+
+    void token(const Token& token) override {
+        if (token.tipo == tk_id){
+            estatisticas.identificadores++;
+            if (token.simbolo == sem_simbolo) estatisticas.simbolos.internar(token.lexema);
+        }
+        if (token.tipo != tk_eof){
+            estatisticas.tokens++;
+            estatisticas.por_tipo[token.tipo]++;
+        } else {
+            // o EOF fica depois do ultimo byte, na linha seguinte a ultima quebra
+            estatisticas.bytes += token.offset;
+            if (linhas != nullptr) estatisticas.linhas += (size_t)linhas->posicao(token.offset).linha - 1;
+        }
+        destino.token(token);
+    }
+
+    void diagnostico(const Diagnostico& erro) override {
+        estatisticas.diagnosticos++;
+        estatisticas.por_categoria[erro.categoria]++;
+        destino.diagnostico(erro);
+    }
+
+private:
+    Saida& destino;
+    EstatisticasLexicas& estatisticas;
+};
+
+// Resumo das estatisticas, uma por linha
+inline void escrever_estatisticas(CanalSaida& canal, const EstatisticasLexicas& estatisticas){
+    canal.escrever("tokens: ");
+    canal.escrever_numero((int64_t)estatisticas.tokens);
+    canal.escrever("\nidentificadores: ");
+    canal.escrever_numero((int64_t)estatisticas.identificadores);
+    canal.escrever("\nidentificadores distintos: ");
+    canal.escrever_numero((int64_t)estatisticas.simbolos.tamanho());
+    canal.escrever(" (");
+    canal.escrever_numero((int64_t)estatisticas.simbolos.bytes_nomes());
+    canal.escrever(" bytes)\nerros lexicos: ");
+    canal.escrever_numero((int64_t)estatisticas.diagnosticos);
+    canal.escrever("\nbytes: ");
+    canal.escrever_numero((int64_t)estatisticas.bytes);
+    canal.escrever("\nlinhas: ");
+    canal.escrever_numero((int64_t)estatisticas.linhas);
+
+    // NUM vale para os dois tipos de numero, entao eles levam o tipo junto
+    canal.escrever("\ntokens por tipo:\n");
+    for (int tipo = 0; tipo < total_tokens; tipo++){
+        if (estatisticas.por_tipo[tipo] == 0) continue;
+        canal.escrever("  ");
+        canal.escrever(tipo == tk_num_int ? "NUM (int)" : tipo == tk_num_float ? "NUM (float)" : nomes_tokens[tipo]);
+        canal.escrever(": ");
+        canal.escrever_numero((int64_t)estatisticas.por_tipo[tipo]);
+        canal.escrever("\n");
+    }
+    canal.escrever("erros por categoria:\n");
+    for (int categoria = 0; categoria < total_categorias_erro; categoria++){
+        canal.escrever("  ");
+        canal.escrever(nomes_erros[categoria]);
+        canal.escrever(": ");
+        canal.escrever_numero((int64_t)estatisticas.por_categoria[categoria]);
+        canal.escrever("\n");
+    }
+}
+
+// Cria a saida do formato pedido sobre os canais de tokens e de erros
+inline std::unique_ptr<Saida> criar_saida(formatos_saida formato, CanalSaida& tokens, CanalSaida& erros, bool posicoes){
+    switch (formato){
+        case formato_jsonl: return std::make_unique<SaidaJsonl>(tokens, erros);
+        case formato_bin: return std::make_unique<SaidaBinaria>(tokens, erros, posicoes ? com_posicoes : 0);
+        default: return std::make_unique<SaidaTexto>(tokens, erros);
+    }
+}
+
+#endif
@@ -0,0 +1,518 @@
+// Compiladores 2025.1 - Servidor do analisador (--serve) e cliente
+//
+// Um processo que fica esperando num socket Unix local e analisa os pedidos
+// de muitos clientes, sem o custo de iniciar um processo novo (carregar o
+// executavel, inicializar iostream, paginar o codigo) a cada arquivo.
+// A thread principal acompanha todas as conexoes com poll(): le os pedidos
+// sem bloquear e so quando um pedido chega inteiro ele vira uma tarefa do
+// ConjuntoThreads (paralelo.h). Assim uma conexao parada entre pedidos nao
+// ocupa nenhuma thread, e um cliente que para no meio de um pedido ou nao le
+// a resposta eh desconectado depois de um prazo. Cada thread tem a sua
+// ArenaTrabalhador, com os buffers de saida reaproveitados de um pedido para
+// o outro; o buffer de entrada eh o da conexao.
+//
+// Protocolo (inteiros na ordem nativa; cliente e servidor estao na mesma
+// maquina), quantos pedidos o cliente quiser por conexao:
+//   pedido:   CabecalhoPedido | 'tamanho' bytes: o caminho do arquivo
+//             (pedido_arquivo) ou o proprio texto fonte (pedido_texto)
+//   resposta: CabecalhoResposta | tokens | erros
+// A resposta traz a saida dos tokens e a dos erros exatamente como o
+// analisador as escreveria em stdout e stderr, e o codigo de saida.
+
+#ifndef SERVIDOR_H
+#define SERVIDOR_H
+
+#include <algorithm>        // min, max
+#include <cstdint>
+#include <cstring>          // memcpy, strerror
+#include <functional>
+#include <string>
+#include <string_view>
+
+#include "saida.h"          // CanalSaida, formatos_saida, escrever_tudo
+
+#ifndef _WIN32
+#include <chrono>
+#include <csignal>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "paralelo.h"       // ConjuntoThreads
+#endif
+
+constexpr char assinatura_pedido[4] = {'C', '-', '-', 'P'};
+constexpr char assinatura_resposta[4] = {'C', '-', '-', 'R'};
+constexpr uint8_t versao_protocolo = 1;
+constexpr uint64_t max_tamanho_pedido = 64 << 20;
+
+// O buffer do corpo de um pedido so cresce com os bytes que ja chegaram
+// (no maximo o dobro deles), e os de todas as conexoes juntos nao passam de
+// max_corpos_pedidos: um cabecalho sozinho nao reserva memoria, e um pedido
+// alem do total fecha a conexao (o cliente entao analisa localmente)
+constexpr size_t max_corpos_pedidos = 256 << 20;
+
+// Prazos do servidor, em milissegundos: conexao sem pedido em andamento,
+// pedido comecado sem chegar mais nada e resposta sem o cliente ler nada
+constexpr int prazo_ocioso_ms = 60000;
+constexpr int prazo_leitura_ms = 10000;
+constexpr int prazo_escrita_ms = 10000;
+
+enum tipos_pedido : uint8_t { pedido_arquivo, pedido_texto };
+
+enum opcoes_pedido : uint8_t {
+    pedido_posicoes = 1 << 0,   // --posicoes
+    pedido_cor = 1 << 1,        // stderr do cliente eh um terminal: erros em vermelho
+};
+
+struct CabecalhoPedido {
+    char assinatura[4];
+    uint8_t versao;
+    uint8_t tipo;
+    uint8_t formato;
+    uint8_t opcoes;
+    uint64_t tamanho;
+};
+
+struct CabecalhoResposta {
+    char assinatura[4];
+    int32_t status;
+    uint64_t tamanho_tokens;
+    uint64_t tamanho_erros;
+};
+
+struct Pedido {
+    tipos_pedido tipo;
+    formatos_saida formato;
+    bool posicoes;
+    bool cor;
+    std::string_view conteudo;      // caminho ou texto fonte (no buffer da conexao)
+};
+
+// Buffers guardados acima disso sao devolvidos depois do pedido: um pedido
+// excepcionalmente grande nao fica segurando a memoria para sempre
+constexpr size_t max_capacidade_retida = 64 << 20;
+
+inline void esvaziar_buffer(std::string& buffer){
+    buffer.clear();
+    if (buffer.capacity() > max_capacidade_retida) buffer.shrink_to_fit();
+}
+
+// Buffers de saida de uma thread do servidor, reaproveitados entre pedidos
+struct ArenaTrabalhador {
+    CanalSaida tokens;
+    CanalSaida erros;
+
+    void limpar(){
+        esvaziar_buffer(tokens.buffer);
+        esvaziar_buffer(erros.buffer);
+    }
+};
+
+// analisa um pedido, escrevendo em arena.tokens e arena.erros; retorna o
+// codigo de saida que o analisador teria
+using TratadorPedido = std::function<int(const Pedido&, ArenaTrabalhador&)>;
+
+#ifndef _WIN32
+
+// le exatamente 'tamanho' bytes (false no fim da conexao ou em erro)
+inline bool ler_tudo(int fd, char* destino, size_t tamanho){
+    while (tamanho > 0){
+        ssize_t lidos = read(fd, destino, tamanho);
+        if (lidos < 0 && errno == EINTR) continue;
+        if (lidos <= 0) return false;
+        destino += lidos;
+        tamanho -= (size_t)lidos;
+    }
+    return true;
+}
+
+inline bool endereco_socket(const std::string& caminho, sockaddr_un& endereco){
+    endereco = {};
+    endereco.sun_family = AF_UNIX;
+    if (caminho.size() >= sizeof(endereco.sun_path)) return false;
+    std::memcpy(endereco.sun_path, caminho.c_str(), caminho.size() + 1);
+    return true;
+}
+
+// conecta ao servidor em 'caminho' (-1 se nao houver servidor)
+inline int conectar_servidor(const std::string& caminho){
+    sockaddr_un endereco;
+    if (!endereco_socket(caminho, endereco)) return -1;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    if (connect(fd, (sockaddr*)&endereco, sizeof endereco) < 0){
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// escreve tudo num socket sem bloqueio; false se a conexao caiu ou se o
+// outro lado ficou prazo_ms sem ler nada
+inline bool enviar_tudo(int fd, const char* dados, size_t tamanho, int prazo_ms){
+    while (tamanho > 0){
+        ssize_t escritos = send(fd, dados, tamanho, MSG_NOSIGNAL);
+        if (escritos < 0){
+            if (errno == EINTR) continue;
+            if (errno != EAGAIN && errno != EWOULDBLOCK) return false;
+            pollfd espera{fd, POLLOUT, 0};
+            int prontos = poll(&espera, 1, prazo_ms);
+            if (prontos < 0 && errno == EINTR) continue;
+            if (prontos <= 0) return false;
+            continue;
+        }
+        dados += escritos;
+        tamanho -= (size_t)escritos;
+    }
+    return true;
+}
+
+class ServidorLexico {
+public:
+    ServidorLexico(std::string caminho, unsigned threads) : caminho(std::move(caminho)), threads(threads) {}
+
+    // atende os pedidos ate SIGINT ou SIGTERM; retorna o codigo de saida
+    int servir(const TratadorPedido& tratador){
+        sockaddr_un endereco;
+        if (!endereco_socket(caminho, endereco)){
+            avisar("Caminho de socket longo demais: " + caminho);
+            return 1;
+        }
+        // um socket que sobrou de um servidor interrompido eh substituido;
+        // um servidor ainda ativo, nao
+        int ativo = conectar_servidor(caminho);
+        if (ativo >= 0){
+            close(ativo);
+            avisar("Ja existe um servidor em " + caminho);
+            return 1;
+        }
+        unlink(caminho.c_str());
+
+        ouvinte = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (ouvinte < 0 || bind(ouvinte, (sockaddr*)&endereco, sizeof endereco) < 0 || listen(ouvinte, 128) < 0 ||
+            pipe2(aviso_devolucao, O_NONBLOCK | O_CLOEXEC) < 0){
+            avisar("Erro ao abrir o socket " + caminho + ": " + strerror(errno));
+            if (ouvinte >= 0) close(ouvinte);
+            return 1;
+        }
+
+        // sem SA_RESTART: o poll() bloqueado volta com EINTR (e, se o sinal
+        // cair em outra thread, o prazo do poll faz o laco ver o pedido)
+        struct sigaction acao{};
+        acao.sa_handler = [](int){ encerrar_servidor() = 1; };
+        sigemptyset(&acao.sa_mask);
+        sigaction(SIGINT, &acao, nullptr);
+        sigaction(SIGTERM, &acao, nullptr);
+        signal(SIGPIPE, SIG_IGN);   // cliente que desistiu: o send falha com EPIPE
+
+        {
+            ConjuntoThreads conjunto(threads);
+            std::vector<pollfd> esperas;
+            std::vector<Conexao*> observadas;   // a conexao de cada espera (depois das duas primeiras)
+            while (!encerrar_servidor()){
+                receber_devolvidas();
+
+                esperas.clear();
+                observadas.clear();
+                int64_t agora = agora_ms();
+                bool aceitando = agora >= retomar_aceite_em;
+                esperas.push_back({aceitando ? ouvinte : -1, POLLIN, 0});
+                esperas.push_back({aviso_devolucao[0], POLLIN, 0});
+                for (auto& [fd, conexao] : conexoes){
+                    if (conexao->ocupada) continue;
+                    esperas.push_back({fd, POLLIN, 0});
+                    observadas.push_back(conexao.get());
+                }
+
+                // acorda pelo menos uma vez por segundo para os prazos e o encerramento
+                if (poll(esperas.data(), esperas.size(), 1000) < 0){
+                    if (errno == EINTR) continue;
+                    avisar(std::string("Erro no poll: ") + strerror(errno));
+                    break;
+                }
+                agora = agora_ms();
+                if (esperas[0].revents & POLLIN) aceitar(agora);
+
+                for (size_t k = 0; k < observadas.size(); k++){
+                    Conexao* conexao = observadas[k];
+                    short eventos = esperas[k + 2].revents;
+                    if (eventos != 0){
+                        estados_leitura estado = ler_pedido(*conexao);
+                        if (estado == leitura_fechada){
+                            fechar(conexao->fd);
+                            continue;
+                        }
+                        if (estado == leitura_parcial) conexao->ultima_atividade = agora;
+                        if (estado == leitura_completa){
+                            conexao->ocupada = true;
+                            conjunto.enviar([this, conexao, &tratador]{ atender(*conexao, tratador); });
+                            continue;
+                        }
+                    }
+                    // pedido parado no meio ou conexao ociosa por tempo demais
+                    int prazo = conexao->lidos > 0 ? prazo_leitura_ms : prazo_ocioso_ms;
+                    if (agora - conexao->ultima_atividade > prazo) fechar(conexao->fd);
+                }
+            }
+            // o conjunto termina os pedidos ja aceitos antes de ser destruido
+        }
+        receber_devolvidas();
+        while (!conexoes.empty()) fechar(conexoes.begin()->first);
+        close(aviso_devolucao[0]);
+        close(aviso_devolucao[1]);
+        close(ouvinte);
+        unlink(caminho.c_str());
+        return 0;
+    }
+
+private:
+    // Uma conexao aberta. Enquanto 'ocupada', o pedido esta com uma thread do
+    // conjunto e a thread principal nao mexe nela
+    struct Conexao {
+        int fd;
+        CabecalhoPedido cabecalho;
+        std::string entrada;            // corpo do pedido, ate onde ja chegou
+        size_t reservado = 0;           // capacidade de 'entrada' contada em bytes_corpos
+        size_t lidos = 0;               // bytes do pedido atual ja lidos (cabecalho + corpo)
+        int64_t ultima_atividade = 0;
+        bool ocupada = false;
+        bool manter = true;             // a resposta foi enviada: a conexao continua
+    };
+
+    enum estados_leitura { leitura_parcial, leitura_completa, leitura_fechada };
+
+    std::string caminho;
+    unsigned threads;
+    int ouvinte = -1;
+    int aviso_devolucao[2] = {-1, -1};  // pipe: uma thread do conjunto terminou um pedido
+    std::map<int, std::unique_ptr<Conexao>> conexoes;   // so a thread principal mexe
+    size_t bytes_corpos = 0;            // soma de 'reservado' de todas as conexoes
+    std::mutex mutex;
+    std::vector<Conexao*> devolvidas;   // pedidos terminados, ainda nao vistos pela thread principal
+    int64_t retomar_aceite_em = 0;      // depois de um erro no accept, espera ate este instante
+    bool avisou_aceite = false;
+
+    static volatile std::sig_atomic_t& encerrar_servidor(){
+        static volatile std::sig_atomic_t encerrar = 0;
+        return encerrar;
+    }
+
+    static int64_t agora_ms(){
+        return std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static void avisar(const std::string& mensagem){
+        std::string linha = mensagem + "\n";
+        escrever_tudo(2, linha.data(), linha.size());
+    }
+
+    // aceita todas as conexoes pendentes. Sem descritores livres (EMFILE,
+    // ENFILE) ou memoria, para de aceitar por um instante em vez de girar no
+    // laco, e avisa uma vez ate o proximo accept dar certo
+    void aceitar(int64_t agora){
+        while (true){
+            int fd = accept4(ouvinte, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+            if (fd >= 0){
+                auto conexao = std::make_unique<Conexao>();
+                conexao->fd = fd;
+                conexao->ultima_atividade = agora;
+                conexoes[fd] = std::move(conexao);
+                avisou_aceite = false;
+                continue;
+            }
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EAGAIN || errno == EWOULDBLOCK) return;
+            if (!avisou_aceite) avisar(std::string("Erro ao aceitar conexao: ") + strerror(errno));
+            avisou_aceite = true;
+            retomar_aceite_em = agora + 100;
+            return;
+        }
+    }
+
+    // le o que ja chegou do pedido atual, sem bloquear
+    estados_leitura ler_pedido(Conexao& conexao){
+        char bloco[1 << 16];
+        while (true){
+            char* destino;
+            size_t falta;
+            if (conexao.lidos < sizeof(CabecalhoPedido)){
+                destino = (char*)&conexao.cabecalho + conexao.lidos;
+                falta = sizeof(CabecalhoPedido) - conexao.lidos;
+            } else {
+                size_t corpo = conexao.lidos - sizeof(CabecalhoPedido);
+                if (corpo == conexao.cabecalho.tamanho) return leitura_completa;
+                destino = bloco;
+                falta = (size_t)std::min<uint64_t>(sizeof bloco, conexao.cabecalho.tamanho - corpo);
+            }
+            ssize_t lidos = recv(conexao.fd, destino, falta, 0);
+            if (lidos < 0 && errno == EINTR) continue;
+            if (lidos < 0 && (errno == EAGAIN || errno == EWOULDBLOCK)) return leitura_parcial;
+            if (lidos <= 0) return leitura_fechada;
+            conexao.lidos += (size_t)lidos;
+            if (destino == bloco && !guardar_corpo(conexao, bloco, (size_t)lidos)) return leitura_fechada;
+
+            // cabecalho completo: valida (o corpo so ocupa memoria ao chegar)
+            if (conexao.lidos == sizeof(CabecalhoPedido)){
+                const CabecalhoPedido& cabecalho = conexao.cabecalho;
+                if (std::memcmp(cabecalho.assinatura, assinatura_pedido, 4) != 0 ||
+                    cabecalho.versao != versao_protocolo || cabecalho.tipo > pedido_texto ||
+                    cabecalho.formato > formato_bin || cabecalho.tamanho > max_tamanho_pedido)
+                    return leitura_fechada;
+            }
+        }
+    }
+
+    // acrescenta bytes que chegaram ao corpo; false se o buffer teria que
+    // passar do total de todas as conexoes
+    bool guardar_corpo(Conexao& conexao, const char* dados, size_t tamanho){
+        std::string& entrada = conexao.entrada;
+        if (entrada.size() + tamanho > entrada.capacity()){
+            size_t capacidade = (size_t)std::min<uint64_t>(conexao.cabecalho.tamanho,
+                                                           std::max(entrada.size() + tamanho, 2 * entrada.capacity()));
+            if (bytes_corpos - conexao.reservado + capacidade > max_corpos_pedidos) return false;
+            entrada.reserve(capacidade);
+            contar_reserva(conexao);
+        }
+        entrada.append(dados, tamanho);
+        return true;
+    }
+
+    void contar_reserva(Conexao& conexao){
+        bytes_corpos = bytes_corpos - conexao.reservado + conexao.entrada.capacity();
+        conexao.reservado = conexao.entrada.capacity();
+    }
+
+    // executado numa thread do conjunto: analisa o pedido completo da
+    // conexao, envia a resposta e devolve a conexao a thread principal
+    void atender(Conexao& conexao, const TratadorPedido& tratador){
+        thread_local ArenaTrabalhador arena;
+        const CabecalhoPedido& cabecalho = conexao.cabecalho;
+        Pedido pedido{(tipos_pedido)cabecalho.tipo, (formatos_saida)cabecalho.formato,
+                      (cabecalho.opcoes & pedido_posicoes) != 0, (cabecalho.opcoes & pedido_cor) != 0,
+                      conexao.entrada};
+        int status = tratador(pedido, arena);
+
+        CabecalhoResposta resposta{};
+        std::memcpy(resposta.assinatura, assinatura_resposta, 4);
+        resposta.status = status;
+        resposta.tamanho_tokens = arena.tokens.buffer.size();
+        resposta.tamanho_erros = arena.erros.buffer.size();
+        conexao.manter = enviar_tudo(conexao.fd, (const char*)&resposta, sizeof resposta, prazo_escrita_ms) &&
+                         enviar_tudo(conexao.fd, arena.tokens.buffer.data(), arena.tokens.buffer.size(), prazo_escrita_ms) &&
+                         enviar_tudo(conexao.fd, arena.erros.buffer.data(), arena.erros.buffer.size(), prazo_escrita_ms);
+        arena.limpar();
+        esvaziar_buffer(conexao.entrada);
+        conexao.lidos = 0;
+
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            devolvidas.push_back(&conexao);
+        }
+        char sinal = 1;
+        ssize_t escrito = write(aviso_devolucao[1], &sinal, 1);  // pipe cheio: ja ha aviso pendente
+        (void)escrito;
+    }
+
+    // as conexoes cujo pedido terminou voltam a ser observadas pelo poll()
+    void receber_devolvidas(){
+        char descarte[256];
+        while (read(aviso_devolucao[0], descarte, sizeof descarte) > 0) {}
+        std::vector<Conexao*> prontas;
+        {
+            std::lock_guard<std::mutex> trava(mutex);
+            prontas.swap(devolvidas);
+        }
+        int64_t agora = agora_ms();
+        for (Conexao* conexao : prontas){
+            conexao->ocupada = false;
+            contar_reserva(*conexao);   // a thread ja esvaziou o buffer
+            conexao->ultima_atividade = agora;
+            if (!conexao->manter) fechar(conexao->fd);
+        }
+    }
+
+    void fechar(int fd){
+        close(fd);
+        auto conexao = conexoes.find(fd);
+        if (conexao == conexoes.end()) return;
+        bytes_corpos -= conexao->second->reservado;
+        conexoes.erase(conexao);
+    }
+};
+
+// Cliente: envia o pedido ao servidor em 'caminho' e escreve a resposta em
+// stdout e stderr. Retorna false, sem ter escrito nada, se nao ha servidor
+// (quem chamou analisa localmente); senao 'status' recebe o codigo de saida
+inline bool pedir_ao_servidor(const std::string& caminho, tipos_pedido tipo, formatos_saida formato, uint8_t opcoes,
+                              std::string_view conteudo, int& status){
+    if (conteudo.size() > max_tamanho_pedido) return false;
+    int fd = conectar_servidor(caminho);
+    if (fd < 0) return false;
+    signal(SIGPIPE, SIG_IGN);
+
+    CabecalhoPedido pedido{};
+    std::memcpy(pedido.assinatura, assinatura_pedido, 4);
+    pedido.versao = versao_protocolo;
+    pedido.tipo = tipo;
+    pedido.formato = (uint8_t)formato;
+    pedido.opcoes = opcoes;
+    pedido.tamanho = conteudo.size();
+    escrever_tudo(fd, (const char*)&pedido, sizeof pedido);
+    escrever_tudo(fd, conteudo.data(), conteudo.size());
+
+    CabecalhoResposta resposta;
+    if (!ler_tudo(fd, (char*)&resposta, sizeof resposta) ||
+        std::memcmp(resposta.assinatura, assinatura_resposta, 4) != 0){
+        close(fd);
+        return false;
+    }
+    // repassa a resposta em blocos, sem guardar tudo na memoria
+    char bloco[1 << 16];
+    uint64_t restantes[2] = {resposta.tamanho_tokens, resposta.tamanho_erros};
+    for (int destino = 1; destino <= 2; destino++){
+        uint64_t& restante = restantes[destino - 1];
+        while (restante > 0){
+            size_t parte = (size_t)std::min<uint64_t>(restante, sizeof bloco);
+            if (!ler_tudo(fd, bloco, parte)){
+                close(fd);
+                status = 1;
+                return true;    // a saida ja comecou: nao da para refazer localmente
+            }
+            escrever_tudo(destino, bloco, parte);
+            restante -= parte;
+        }
+    }
+    close(fd);
+    status = resposta.status;
+    return true;
+}
+
+#else
+
+class ServidorLexico {
+public:
+    ServidorLexico(std::string, unsigned){}
+
+    int servir(const TratadorPedido&){
+        const char mensagem[] = "--serve disponivel apenas no linux\n";
+        escrever_tudo(2, mensagem, sizeof mensagem - 1);
+        return 1;
+    }
+};
+
+inline bool pedir_ao_servidor(const std::string&, tipos_pedido, formatos_saida, uint8_t, std::string_view, int&){
+    return false;
+}
+
+#endif
+
+#endif
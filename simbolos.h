@@ -0,0 +1,130 @@
+// Compiladores 2025.1 - Tabela de simbolos
+//
+// Interna os identificadores: cada nome distinto recebe um id de 32 bits
+// estavel (0, 1, 2, ... na ordem em que aparece) e o texto eh copiado uma
+// unica vez para uma arena. As fases seguintes comparam ids em vez de strings.
+//
+// A tabela eh um hash de enderecamento aberto (sondagem linear) com o hash e
+// o id lado a lado em 8 bytes por entrada, mantida no maximo meio cheia.
+
+#ifndef SIMBOLOS_H
+#define SIMBOLOS_H
+
+#include <algorithm>    // max
+#include <cstdint>
+#include <cstring>      // memcpy
+#include <memory>       // unique_ptr
+#include <string_view>
+#include <vector>
+
+// id de um token que nao passou por uma tabela de simbolos
+constexpr uint32_t sem_simbolo = 0xffffffff;
+
+// Hash dos bytes do nome, lidos de 8 em 8
+inline uint32_t hash_simbolo(const char* p, size_t n){
+    uint64_t h = 0x9e3779b97f4a7c15ull ^ n;
+    while (n >= 8){
+        uint64_t bloco;
+        memcpy(&bloco, p, 8);
+        h = (h ^ bloco) * 0xff51afd7ed558ccdull;
+        h ^= h >> 32;
+        p += 8;
+        n -= 8;
+    }
+    uint64_t resto = 0;
+    memcpy(&resto, p, n);
+    h = (h ^ resto) * 0xff51afd7ed558ccdull;
+    h ^= h >> 29;
+    return (uint32_t)h;
+}
+
+// Memoria para textos que vivem ate o fim da arena: aloca em blocos grandes
+// e nunca libera um texto sozinho
+class Arena {
+public:
+    static constexpr size_t tamanho_bloco = 64 * 1024;
+
+    // copia o texto para a arena; o ponteiro vale enquanto a arena existir
+    const char* copiar(std::string_view texto){
+        if (texto.size() > livre){
+            size_t tamanho = std::max(tamanho_bloco, texto.size());
+            blocos.emplace_back(new char[tamanho]);
+            atual = blocos.back().get();
+            livre = tamanho;
+        }
+        char* copia = atual;
+        memcpy(copia, texto.data(), texto.size());
+        atual += texto.size();
+        livre -= texto.size();
+        usados += texto.size();
+        return copia;
+    }
+
+    size_t bytes_usados() const { return usados; }
+
+private:
+    std::vector<std::unique_ptr<char[]>> blocos;
+    char* atual = nullptr;
+    size_t livre = 0;
+    size_t usados = 0;
+};
+
+class TabelaSimbolos {
+public:
+    // id do nome, inserindo-o se ainda nao existir
+    uint32_t internar(std::string_view nome){
+        if ((nomes.size() + 1) * 2 > entradas.size()) crescer();
+        uint32_t hash = hash_simbolo(nome.data(), nome.size());
+        size_t mascara = entradas.size() - 1;
+        for (size_t i = hash & mascara;; i = (i + 1) & mascara){
+            Entrada& entrada = entradas[i];
+            if (entrada.id == sem_simbolo){
+                entrada = {hash, (uint32_t)nomes.size()};
+                nomes.emplace_back(arena.copiar(nome), nome.size());
+                return entrada.id;
+            }
+            if (entrada.hash == hash && nomes[entrada.id] == nome) return entrada.id;
+        }
+    }
+
+    // id do nome, ou sem_simbolo se ele nunca foi internado
+    uint32_t procurar(std::string_view nome) const {
+        if (entradas.empty()) return sem_simbolo;
+        uint32_t hash = hash_simbolo(nome.data(), nome.size());
+        size_t mascara = entradas.size() - 1;
+        for (size_t i = hash & mascara;; i = (i + 1) & mascara){
+            const Entrada& entrada = entradas[i];
+            if (entrada.id == sem_simbolo) return sem_simbolo;
+            if (entrada.hash == hash && nomes[entrada.id] == nome) return entrada.id;
+        }
+    }
+
+    std::string_view nome(uint32_t id) const { return nomes[id]; }
+    size_t tamanho() const { return nomes.size(); }
+    size_t bytes_nomes() const { return arena.bytes_usados(); }
+
+private:
+    struct Entrada {
+        uint32_t hash;
+        uint32_t id;    // sem_simbolo marca entrada vazia
+    };
+
+    std::vector<Entrada> entradas;          // tamanho sempre potencia de 2
+    std::vector<std::string_view> nomes;    // nome de cada id, apontando para a arena
+    Arena arena;
+
+    // dobra a tabela e reposiciona as entradas pelo hash guardado
+    void crescer(){
+        std::vector<Entrada> antigas(std::max<size_t>(1024, entradas.size() * 2), Entrada{0, sem_simbolo});
+        antigas.swap(entradas);
+        size_t mascara = entradas.size() - 1;
+        for (const Entrada& entrada : antigas){
+            if (entrada.id == sem_simbolo) continue;
+            size_t i = entrada.hash & mascara;
+            while (entradas[i].id != sem_simbolo) i = (i + 1) & mascara;
+            entradas[i] = entrada;
+        }
+    }
+};
+
+#endif
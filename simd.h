@@ -0,0 +1,369 @@
+// Compiladores 2025.1 - Rotinas vetoriais do Analisador Lexico
+//
+// Pulos rapidos sobre trechos que nao geram tokens (sequencias de espacos e
+// o corpo de comentarios de bloco), busca do fim de identificadores e
+// numeros, o indice das quebras de linha (linhas.h) e a passada que confirma
+// trechos so de ASCII. Em x86 as rotinas comparam 16 (SSE2) ou 32 (AVX2)
+// bytes por vez. A versao usada eh escolhida uma vez,
+// pela CPU em que o programa roda; as demais plataformas (ou CPUs sem SSE2)
+// usam a versao escalar.
+
+#ifndef SIMD_H
+#define SIMD_H
+
+#include <cstddef>      // size_t
+#include <cstdint>
+
+#include "tabelas.h"
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Resultado de um pulo sobre [p, fim)
+struct Pulo {
+    const char* fim;            // primeiro byte depois do trecho pulado
+    bool fechou;                // comentario: encontrou o "*/"
+};
+
+// ---------------------------------------------------------------------------
+// Versao escalar (um byte por vez)
+
+// pula espacos, tabs e quebras de linha a partir de p
+inline Pulo pular_espacos_escalar(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    while (pulo.fim < fim){
+        uint8_t classe = tabela_classes[(unsigned char)*pulo.fim];
+        if (classe != quebra_linha && classe != espaco_em_branco) break;
+        pulo.fim++;
+    }
+    return pulo;
+}
+
+// pula o corpo de um comentario (p logo depois do "/*") ate depois do "*/"
+inline Pulo pular_comentario_escalar(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    while (pulo.fim < fim){
+        char c = *pulo.fim;
+        if (c == '*' && pulo.fim + 1 < fim && pulo.fim[1] == '/'){
+            pulo.fim += 2;
+            pulo.fechou = true;
+            return pulo;
+        }
+        pulo.fim++;
+    }
+    return pulo;
+}
+
+// fim da sequencia de letras, digitos e '_' que comeca em p
+inline const char* fim_identificador_escalar(const char* p, const char* fim){
+    while (p < fim){
+        uint8_t classe = tabela_classes[(unsigned char)*p];
+        if (classe != letra && classe != digito && classe != underline) break;
+        p++;
+    }
+    return p;
+}
+
+// fim da sequencia de digitos que comeca em p
+inline const char* fim_digitos_escalar(const char* p, const char* fim){
+    while (p < fim && tabela_classes[(unsigned char)*p] == digito) p++;
+    return p;
+}
+
+// grava em 'destino' o offset (base + posicao) de cada '\n' de [p, fim),
+// que precisa ter espaco para fim - p offsets; retorna quantos gravou
+inline size_t indexar_quebras_escalar(const char* p, const char* fim, size_t base, size_t* destino){
+    size_t n = 0;
+    for (const char* c = p; c < fim; c++)
+        if (*c == '\n') destino[n++] = base + (size_t)(c - p);
+    return n;
+}
+
+inline size_t contar_quebras_escalar(const char* p, const char* fim){
+    size_t n = 0;
+    for (; p < fim; p++) n += *p == '\n';
+    return n;
+}
+
+// primeiro byte fora do ASCII (>= 0x80) a partir de p
+inline const char* fim_ascii_escalar(const char* p, const char* fim){
+    while (p < fim && (unsigned char)*p < 0x80) p++;
+    return p;
+}
+
+#ifdef SIMD_X86
+
+// grava os offsets dos bits marcados em 'quebras' (bit i = bloco[i])
+inline size_t gravar_quebras(uint32_t quebras, size_t base, size_t* destino){
+    size_t n = 0;
+    while (quebras){
+        destino[n++] = base + (size_t)__builtin_ctz(quebras);
+        quebras &= quebras - 1;
+    }
+    return n;
+}
+
+// ---------------------------------------------------------------------------
+// SSE2: 16 bytes por comparacao
+
+__attribute__((target("sse2")))
+inline Pulo pular_espacos_sse2(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    const __m128i nove = _mm_set1_epi8(9);
+    const __m128i quatro = _mm_set1_epi8(4);
+    const __m128i espaco = _mm_set1_epi8(' ');
+
+    while (fim - pulo.fim >= 16){
+        __m128i bytes = _mm_loadu_si128((const __m128i*)pulo.fim);
+        // '\t' '\n' '\v' '\f' '\r' sao 9..13: (c - 9) <= 4 sem sinal
+        __m128i deslocado = _mm_sub_epi8(bytes, nove);
+        __m128i controle = _mm_cmpeq_epi8(_mm_min_epu8(deslocado, quatro), deslocado);
+        __m128i brancos = _mm_or_si128(controle, _mm_cmpeq_epi8(bytes, espaco));
+
+        uint32_t mascara = (uint32_t)_mm_movemask_epi8(brancos);
+        if (mascara != 0xffff){
+            pulo.fim += __builtin_ctz(~mascara);
+            return pulo;
+        }
+        pulo.fim += 16;
+    }
+    return pular_espacos_escalar(pulo.fim, fim);
+}
+
+__attribute__((target("sse2")))
+inline Pulo pular_comentario_sse2(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    const __m128i asterisco = _mm_set1_epi8('*');
+    const __m128i barra = _mm_set1_epi8('/');
+
+    // le 17 bytes: o '/' do fechamento pode estar logo depois do bloco
+    while (fim - pulo.fim >= 17){
+        __m128i bytes = _mm_loadu_si128((const __m128i*)pulo.fim);
+        __m128i seguintes = _mm_loadu_si128((const __m128i*)(pulo.fim + 1));
+        uint32_t fecha = (uint32_t)(_mm_movemask_epi8(_mm_cmpeq_epi8(bytes, asterisco))
+                                  & _mm_movemask_epi8(_mm_cmpeq_epi8(seguintes, barra)));
+        if (fecha){
+            pulo.fim += __builtin_ctz(fecha) + 2;
+            pulo.fechou = true;
+            return pulo;
+        }
+        pulo.fim += 16;
+    }
+    return pular_comentario_escalar(pulo.fim, fim);
+}
+
+// marca os bytes [A-Za-z0-9_] do bloco
+__attribute__((target("sse2")))
+inline __m128i classificar_identificador_sse2(__m128i bytes){
+    // letras: (c | 0x20) - 'a' <= 25; digitos: c - '0' <= 9 (sem sinal)
+    __m128i minuscula = _mm_sub_epi8(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+    __m128i letras = _mm_cmpeq_epi8(_mm_min_epu8(minuscula, _mm_set1_epi8(25)), minuscula);
+    __m128i deslocado = _mm_sub_epi8(bytes, _mm_set1_epi8('0'));
+    __m128i digitos = _mm_cmpeq_epi8(_mm_min_epu8(deslocado, _mm_set1_epi8(9)), deslocado);
+    __m128i sublinhado = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('_'));
+    return _mm_or_si128(_mm_or_si128(letras, digitos), sublinhado);
+}
+
+__attribute__((target("sse2")))
+inline const char* fim_identificador_sse2(const char* p, const char* fim){
+    while (fim - p >= 16){
+        uint32_t mascara = (uint32_t)_mm_movemask_epi8(classificar_identificador_sse2(_mm_loadu_si128((const __m128i*)p)));
+        if (mascara != 0xffff) return p + __builtin_ctz(~mascara);
+        p += 16;
+    }
+    return fim_identificador_escalar(p, fim);
+}
+
+__attribute__((target("sse2")))
+inline const char* fim_digitos_sse2(const char* p, const char* fim){
+    const __m128i zero = _mm_set1_epi8('0');
+    const __m128i nove = _mm_set1_epi8(9);
+    while (fim - p >= 16){
+        __m128i deslocado = _mm_sub_epi8(_mm_loadu_si128((const __m128i*)p), zero);
+        uint32_t mascara = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_min_epu8(deslocado, nove), deslocado));
+        if (mascara != 0xffff) return p + __builtin_ctz(~mascara);
+        p += 16;
+    }
+    return fim_digitos_escalar(p, fim);
+}
+
+__attribute__((target("sse2")))
+inline size_t indexar_quebras_sse2(const char* p, const char* fim, size_t base, size_t* destino){
+    const __m128i quebra = _mm_set1_epi8('\n');
+    size_t n = 0;
+    const char* bloco = p;
+    for (; fim - bloco >= 16; bloco += 16){
+        uint32_t quebras = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)bloco), quebra));
+        n += gravar_quebras(quebras, base + (size_t)(bloco - p), destino + n);
+    }
+    return n + indexar_quebras_escalar(bloco, fim, base + (size_t)(bloco - p), destino + n);
+}
+
+__attribute__((target("sse2")))
+inline size_t contar_quebras_sse2(const char* p, const char* fim){
+    const __m128i quebra = _mm_set1_epi8('\n');
+    size_t n = 0;
+    for (; fim - p >= 16; p += 16)
+        n += (size_t)__builtin_popcount((uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_loadu_si128((const __m128i*)p), quebra)));
+    return n + contar_quebras_escalar(p, fim);
+}
+
+// o bit alto de cada byte ja eh o que o movemask junta
+__attribute__((target("sse2")))
+inline const char* fim_ascii_sse2(const char* p, const char* fim){
+    while (fim - p >= 16){
+        uint32_t mascara = (uint32_t)_mm_movemask_epi8(_mm_loadu_si128((const __m128i*)p));
+        if (mascara) return p + __builtin_ctz(mascara);
+        p += 16;
+    }
+    return fim_ascii_escalar(p, fim);
+}
+
+// ---------------------------------------------------------------------------
+// AVX2: 32 bytes por comparacao
+
+__attribute__((target("avx2")))
+inline Pulo pular_espacos_avx2(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    const __m256i nove = _mm256_set1_epi8(9);
+    const __m256i quatro = _mm256_set1_epi8(4);
+    const __m256i espaco = _mm256_set1_epi8(' ');
+
+    while (fim - pulo.fim >= 32){
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)pulo.fim);
+        __m256i deslocado = _mm256_sub_epi8(bytes, nove);
+        __m256i controle = _mm256_cmpeq_epi8(_mm256_min_epu8(deslocado, quatro), deslocado);
+        __m256i brancos = _mm256_or_si256(controle, _mm256_cmpeq_epi8(bytes, espaco));
+
+        uint32_t mascara = (uint32_t)_mm256_movemask_epi8(brancos);
+        if (mascara != 0xffffffffu){
+            pulo.fim += __builtin_ctz(~mascara);
+            return pulo;
+        }
+        pulo.fim += 32;
+    }
+    return pular_espacos_sse2(pulo.fim, fim);
+}
+
+__attribute__((target("avx2")))
+inline Pulo pular_comentario_avx2(const char* p, const char* fim){
+    Pulo pulo{p, false};
+    const __m256i asterisco = _mm256_set1_epi8('*');
+    const __m256i barra = _mm256_set1_epi8('/');
+
+    while (fim - pulo.fim >= 33){
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)pulo.fim);
+        __m256i seguintes = _mm256_loadu_si256((const __m256i*)(pulo.fim + 1));
+        uint32_t fecha = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, asterisco))
+                       & (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(seguintes, barra));
+        if (fecha){
+            pulo.fim += __builtin_ctz(fecha) + 2;
+            pulo.fechou = true;
+            return pulo;
+        }
+        pulo.fim += 32;
+    }
+    return pular_comentario_sse2(pulo.fim, fim);
+}
+
+__attribute__((target("avx2")))
+inline const char* fim_identificador_avx2(const char* p, const char* fim){
+    while (fim - p >= 32){
+        __m256i bytes = _mm256_loadu_si256((const __m256i*)p);
+        __m256i minuscula = _mm256_sub_epi8(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+        __m256i letras = _mm256_cmpeq_epi8(_mm256_min_epu8(minuscula, _mm256_set1_epi8(25)), minuscula);
+        __m256i deslocado = _mm256_sub_epi8(bytes, _mm256_set1_epi8('0'));
+        __m256i digitos = _mm256_cmpeq_epi8(_mm256_min_epu8(deslocado, _mm256_set1_epi8(9)), deslocado);
+        __m256i sublinhado = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_'));
+        uint32_t mascara = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(_mm256_or_si256(letras, digitos), sublinhado));
+        if (mascara != 0xffffffffu) return p + __builtin_ctz(~mascara);
+        p += 32;
+    }
+    return fim_identificador_sse2(p, fim);
+}
+
+__attribute__((target("avx2")))
+inline const char* fim_digitos_avx2(const char* p, const char* fim){
+    const __m256i zero = _mm256_set1_epi8('0');
+    const __m256i nove = _mm256_set1_epi8(9);
+    while (fim - p >= 32){
+        __m256i deslocado = _mm256_sub_epi8(_mm256_loadu_si256((const __m256i*)p), zero);
+        uint32_t mascara = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_min_epu8(deslocado, nove), deslocado));
+        if (mascara != 0xffffffffu) return p + __builtin_ctz(~mascara);
+        p += 32;
+    }
+    return fim_digitos_sse2(p, fim);
+}
+
+__attribute__((target("avx2")))
+inline size_t indexar_quebras_avx2(const char* p, const char* fim, size_t base, size_t* destino){
+    const __m256i quebra = _mm256_set1_epi8('\n');
+    size_t n = 0;
+    const char* bloco = p;
+    for (; fim - bloco >= 32; bloco += 32){
+        uint32_t quebras = (uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)bloco), quebra));
+        n += gravar_quebras(quebras, base + (size_t)(bloco - p), destino + n);
+    }
+    return n + indexar_quebras_sse2(bloco, fim, base + (size_t)(bloco - p), destino + n);
+}
+
+__attribute__((target("avx2")))
+inline size_t contar_quebras_avx2(const char* p, const char* fim){
+    const __m256i quebra = _mm256_set1_epi8('\n');
+    size_t n = 0;
+    for (; fim - p >= 32; p += 32)
+        n += (size_t)__builtin_popcount((uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*)p), quebra)));
+    return n + contar_quebras_sse2(p, fim);
+}
+
+__attribute__((target("avx2")))
+inline const char* fim_ascii_avx2(const char* p, const char* fim){
+    while (fim - p >= 32){
+        uint32_t mascara = (uint32_t)_mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*)p));
+        if (mascara) return p + __builtin_ctz(mascara);
+        p += 32;
+    }
+    return fim_ascii_sse2(p, fim);
+}
+
+#endif
+
+// ---------------------------------------------------------------------------
+// Escolha da versao em tempo de execucao
+
+enum niveis_simd { simd_escalar, simd_sse2, simd_avx2 };
+
+struct RotinasSimd {
+    niveis_simd nivel;
+    Pulo (*pular_espacos)(const char* p, const char* fim);
+    Pulo (*pular_comentario)(const char* p, const char* fim);
+    const char* (*fim_identificador)(const char* p, const char* fim);
+    const char* (*fim_digitos)(const char* p, const char* fim);
+    size_t (*indexar_quebras)(const char* p, const char* fim, size_t base, size_t* destino);
+    size_t (*contar_quebras)(const char* p, const char* fim);
+    const char* (*fim_ascii)(const char* p, const char* fim);
+};
+
+// rotinas do nivel pedido, limitado ao que a CPU suporta
+inline RotinasSimd rotinas_para(niveis_simd nivel){
+#ifdef SIMD_X86
+    __builtin_cpu_init();
+    if (nivel >= simd_avx2 && __builtin_cpu_supports("avx2"))
+        return {simd_avx2, pular_espacos_avx2, pular_comentario_avx2, fim_identificador_avx2, fim_digitos_avx2,
+                indexar_quebras_avx2, contar_quebras_avx2, fim_ascii_avx2};
+    if (nivel >= simd_sse2 && __builtin_cpu_supports("sse2"))
+        return {simd_sse2, pular_espacos_sse2, pular_comentario_sse2, fim_identificador_sse2, fim_digitos_sse2,
+                indexar_quebras_sse2, contar_quebras_sse2, fim_ascii_sse2};
+#else
+    (void)nivel;
+#endif
+    return {simd_escalar, pular_espacos_escalar, pular_comentario_escalar, fim_identificador_escalar, fim_digitos_escalar,
+            indexar_quebras_escalar, contar_quebras_escalar, fim_ascii_escalar};
+}
+
+// Rotinas em uso pelo Lexer (a melhor disponivel; pode ser trocada para comparacoes)
+inline RotinasSimd rotinas_simd = rotinas_para(simd_avx2);
+
+#endif
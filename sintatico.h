@@ -0,0 +1,401 @@
+// Compiladores 2025.1 - Analisador Sintatico
+//
+// Descida recursiva sobre os tokens do Lexer (puxados um a um, sem guardar
+// a lista de tokens), montando a Arvore de ast.h. Gramatica:
+//
+//   programa   -> comando* EOF
+//   comando    -> tipo variavel (',' variavel)* ';'       tipo: int float char bool
+//               | '{' comando* '}'
+//               | if '(' expressao ')' comando (else comando)?
+//               | while '(' expressao ')' comando
+//               | break ';' | print '(' expressao ')' ';' | readln '(' ID ')' ';'
+//               | return expressao? ';' | expressao ';' | ';'
+//   variavel   -> ID ('=' expressao)?
+//   expressao  -> binaria ('=' expressao)?               (a esquerda precisa ser um ID)
+//   binaria    -> unaria (op unaria)*                    por precedencia, da menor a maior:
+//                                                          || && (== !=) (< <= > >=) (+ -) (* / %)
+//   unaria     -> ('-' | '!') unaria | ('++' | '--') ID | primaria
+//   primaria   -> ID ('++' | '--')? | NUM | true | false | '(' expressao ')'
+//
+// Os erros nao interrompem a analise: cada um fica em Parser::erros e o
+// parser se recupera descartando tokens ate o proximo ';' (consumido) ou '}'
+// (que fecha o bloco). Ate la os erros seguintes sao omitidos, para que um
+// erro so nao gere uma cascata de mensagens. Os erros lexicos continuam em
+// lexer.diagnosticos.
+//
+// Os tokens podem vir de outra fonte com a interface do Lexer (proximo(),
+// diagnosticos e simbolos), como TokensEncadeados de encadeado.h, que roda o
+// Lexer em outra thread.
+
+#ifndef SINTATICO_H
+#define SINTATICO_H
+
+#include <string_view>
+#include <vector>
+
+#include "ast.h"
+#include "lexer.h"
+#include "linhas.h"
+#include "saida.h"      // CanalSaida, formatar_diagnostico
+
+// Erro sintatico: 'esperado' faltou antes do token 'encontrado'
+struct ErroSintatico {
+    size_t offset;
+    std::string_view encontrado;    // lexema do token (vazio no fim do arquivo)
+    const char* esperado;
+};
+
+template<class FonteTokens = Lexer>
+class Parser {
+public:
+    // blocos, parenteses e operadores unarios aninhados alem disso sao erro
+    // (cada nivel custa alguns quadros da pilha de chamadas)
+    static constexpr int max_aninhamento = 1000;
+
+    std::vector<ErroSintatico> erros;
+
+    // os IDs sao internados em 'simbolos' (o Lexer passa a usa-la)
+    Parser(FonteTokens& lexer, Arvore& arvore, TabelaSimbolos& simbolos) : lexer(lexer), arvore(arvore){
+        lexer.simbolos = &simbolos;
+        avancar();
+    }
+
+    // analisa o programa inteiro; retorna a raiz (tambem em arvore.raiz)
+    uint32_t programa(){
+        arvore.raiz = arvore.criar(no_programa, atual.offset);
+        ListaFilhos comandos(arvore, arvore.raiz);
+        while (atual.tipo != tk_eof){
+            // '}' sem '{': descarta, senao o laco nao anda (uma sequencia
+            // deles gera um erro so)
+            if (atual.tipo == tk_rbrace){
+                erro("comando");
+                avancar();
+                continue;
+            }
+            comandos.acrescentar(comando());
+        }
+        return arvore.raiz;
+    }
+
+private:
+    FonteTokens& lexer;
+    Arvore& arvore;
+    Token atual{};
+    bool em_panico = false;     // ja reportou um erro e ainda nao se recuperou
+    int aninhamento = 0;
+
+    void avancar(){ atual = lexer.proximo(); }
+
+    bool aceitar(tipos_token tipo){
+        if (atual.tipo != tipo) return false;
+        avancar();
+        return true;
+    }
+
+    bool esperar(tipos_token tipo, const char* esperado){
+        if (aceitar(tipo)) return true;
+        erro(esperado);
+        return false;
+    }
+
+    void erro(const char* esperado){
+        if (!em_panico) erros.push_back({atual.offset, atual.lexema, esperado});
+        em_panico = true;
+    }
+
+    // descarta ate depois do proximo ';' ou ate o '}' que fecha o bloco
+    void sincronizar(){
+        while (atual.tipo != tk_semicolon && atual.tipo != tk_rbrace && atual.tipo != tk_eof) avancar();
+        aceitar(tk_semicolon);
+    }
+
+    void fim_comando(){
+        if (!esperar(tk_semicolon, "';'")) sincronizar();
+    }
+
+    uint32_t criar(tipos_no tipo, tipos_token operador = tk_eof){
+        return arvore.criar(tipo, atual.offset, operador);
+    }
+
+    // no com um ou dois filhos ja criados
+    uint32_t ligar(uint32_t pai, uint32_t primeiro, uint32_t segundo = sem_no){
+        arvore[pai].filho = primeiro;
+        arvore[primeiro].irmao = segundo;
+        return pai;
+    }
+
+    uint32_t comando(){
+        if (aninhamento >= max_aninhamento){
+            erro("no máximo 1000 níveis de aninhamento");
+            sincronizar();
+            em_panico = false;
+            return criar(no_vazio);
+        }
+        aninhamento++;
+        uint32_t no;
+        switch (atual.tipo){
+            case tk_int:
+            case tk_float:
+            case tk_char:
+            case tk_bool:
+                no = declaracao();
+                break;
+            case tk_lbrace:
+                no = bloco();
+                break;
+            case tk_if:
+                no = comando_if();
+                break;
+            case tk_while: {
+                no = criar(no_while);
+                avancar();
+                uint32_t condicao = entre_parenteses();
+                ligar(no, condicao, comando());
+                break;
+            }
+            case tk_break:
+                no = criar(no_break);
+                avancar();
+                fim_comando();
+                break;
+            case tk_print: {
+                no = criar(no_print);
+                avancar();
+                ligar(no, entre_parenteses());
+                fim_comando();
+                break;
+            }
+            case tk_readln: {
+                no = criar(no_readln);
+                avancar();
+                esperar(tk_lparent, "'('");
+                ligar(no, identificador());
+                esperar(tk_rparent, "')'");
+                fim_comando();
+                break;
+            }
+            case tk_return:
+                no = criar(no_return);
+                avancar();
+                if (atual.tipo != tk_semicolon) ligar(no, expressao());
+                fim_comando();
+                break;
+            case tk_semicolon:
+                no = criar(no_vazio);
+                avancar();
+                break;
+            default:
+                no = criar(no_expressao);
+                ligar(no, expressao());
+                fim_comando();
+                break;
+        }
+        aninhamento--;
+        em_panico = false;
+        return no;
+    }
+
+    uint32_t declaracao(){
+        uint32_t no = criar(no_declaracao, atual.tipo);
+        avancar();
+        ListaFilhos variaveis(arvore, no);
+        do {
+            uint32_t variavel = criar(no_variavel);
+            arvore[variavel].simbolo = atual.simbolo;
+            if (esperar(tk_id, "identificador") && aceitar(tk_assign)) ligar(variavel, expressao());
+            variaveis.acrescentar(variavel);
+        } while (aceitar(tk_comma));
+        fim_comando();
+        return no;
+    }
+
+    uint32_t bloco(){
+        uint32_t no = criar(no_bloco);
+        avancar();
+        ListaFilhos comandos(arvore, no);
+        while (atual.tipo != tk_rbrace && atual.tipo != tk_eof) comandos.acrescentar(comando());
+        esperar(tk_rbrace, "'}'");
+        return no;
+    }
+
+    uint32_t comando_if(){
+        uint32_t no = criar(no_if);
+        avancar();
+        uint32_t condicao = entre_parenteses();
+        uint32_t entao = comando();
+        ligar(no, condicao, entao);
+        if (aceitar(tk_else)) arvore[entao].irmao = comando();
+        return no;
+    }
+
+    uint32_t entre_parenteses(){
+        esperar(tk_lparent, "'('");
+        uint32_t condicao = expressao();
+        esperar(tk_rparent, "')'");
+        return condicao;
+    }
+
+    uint32_t identificador(){
+        uint32_t no = criar(no_id);
+        arvore[no].simbolo = atual.simbolo;
+        esperar(tk_id, "identificador");
+        return no;
+    }
+
+    // precedencia dos operadores binarios (0: nao eh binario)
+    static int precedencia(tipos_token tipo){
+        switch (tipo){
+            case tk_or: return 1;
+            case tk_and: return 2;
+            case tk_eq: case tk_diff: return 3;
+            case tk_lt: case tk_leq: case tk_gt: case tk_geq: return 4;
+            case tk_plus: case tk_minus: return 5;
+            case tk_mult: case tk_div: case tk_mod: return 6;
+            default: return 0;
+        }
+    }
+
+    uint32_t expressao(){
+        uint32_t alvo = binaria(1);
+        if (atual.tipo != tk_assign) return alvo;
+        if (arvore[alvo].tipo != no_id) erro("identificador");
+        uint32_t no = criar(no_atribuicao);
+        avancar();
+        if (aninhamento >= max_aninhamento){
+            erro("no máximo 1000 níveis de aninhamento");
+            return ligar(no, alvo, criar(no_erro));
+        }
+        aninhamento++;
+        uint32_t valor = expressao();
+        aninhamento--;
+        return ligar(no, alvo, valor);
+    }
+
+    // operadores da mesma precedencia associam a esquerda
+    uint32_t binaria(int minima){
+        uint32_t esquerda = unaria();
+        while (true){
+            int p = precedencia(atual.tipo);
+            if (p < minima || p == 0) return esquerda;
+            uint32_t no = criar(no_binario, atual.tipo);
+            avancar();
+            esquerda = ligar(no, esquerda, binaria(p + 1));
+        }
+    }
+
+    uint32_t unaria(){
+        switch (atual.tipo){
+            case tk_minus:
+            case tk_neg: {
+                if (aninhamento >= max_aninhamento){
+                    erro("no máximo 1000 níveis de aninhamento");
+                    return criar(no_erro);
+                }
+                uint32_t no = criar(no_unario, atual.tipo);
+                avancar();
+                aninhamento++;
+                ligar(no, unaria());
+                aninhamento--;
+                return no;
+            }
+            case tk_increment:
+            case tk_decrement: {
+                uint32_t no = criar(no_incremento, atual.tipo);
+                arvore[no].valor.inteiro = 1;
+                avancar();
+                return ligar(no, identificador());
+            }
+            default:
+                return primaria();
+        }
+    }
+
+    uint32_t primaria(){
+        uint32_t no;
+        switch (atual.tipo){
+            case tk_id:
+                no = criar(no_id);
+                arvore[no].simbolo = atual.simbolo;
+                avancar();
+                if (atual.tipo == tk_increment || atual.tipo == tk_decrement){
+                    uint32_t incremento = criar(no_incremento, atual.tipo);
+                    avancar();
+                    return ligar(incremento, no);
+                }
+                return no;
+            case tk_num_int:
+            case tk_num_float:
+                no = criar(atual.tipo == tk_num_int ? no_inteiro : no_real);
+                arvore[no].valor = atual.valor;
+                avancar();
+                return no;
+            case tk_true:
+            case tk_false:
+                no = criar(no_booleano);
+                arvore[no].valor.inteiro = atual.tipo == tk_true;
+                avancar();
+                return no;
+            case tk_lparent:
+                if (aninhamento >= max_aninhamento){
+                    erro("no máximo 1000 níveis de aninhamento");
+                    return criar(no_erro);
+                }
+                avancar();
+                aninhamento++;
+                no = expressao();
+                aninhamento--;
+                esperar(tk_rparent, "')'");
+                return no;
+            default:
+                // nada consumido: quem chamou decide onde retomar
+                erro("expressão");
+                return criar(no_erro);
+        }
+    }
+};
+
+// "Encontrado ERRO SINTATICO na linha L, coluna C: esperado ';' antes de 'x'"
+inline void formatar_erro_sintatico(CanalSaida& canal, const ErroSintatico& erro, PosicaoTexto posicao, bool cor,
+                                    std::string_view origem = {}){
+    if (cor) canal.escrever("\033[31m");
+    if (!origem.empty()){
+        canal.escrever(origem);
+        canal.escrever(": ");
+    }
+    canal.escrever("Encontrado ERRO SINTÁTICO na linha ");
+    canal.escrever_numero(posicao.linha);
+    canal.escrever(", coluna ");
+    canal.escrever_numero(posicao.coluna);
+    canal.escrever(": esperado ");
+    canal.escrever(erro.esperado);
+    if (erro.encontrado.empty()){
+        canal.escrever(" antes do fim do arquivo");
+    } else {
+        canal.escrever(" antes de '");
+        canal.escrever(erro.encontrado);
+        canal.escrever("'");
+    }
+    if (cor) canal.escrever("\033[0m");
+    canal.escrever("\n");
+}
+
+// Erros lexicos e sintaticos juntos, na ordem do texto (no mesmo offset o
+// lexico vem antes). Retorna quantos erros foram escritos
+inline size_t escrever_erros(CanalSaida& canal, const std::vector<Diagnostico>& lexicos,
+                             const std::vector<ErroSintatico>& sintaticos, IndiceLinhas& linhas,
+                             std::string_view origem = {}){
+    size_t i = 0, j = 0;
+    while (i < lexicos.size() || j < sintaticos.size()){
+        if (j == sintaticos.size() || (i < lexicos.size() && lexicos[i].offset <= sintaticos[j].offset)){
+            formatar_diagnostico(canal, lexicos[i], linhas.posicao(lexicos[i].offset), canal.interativo, origem);
+            i++;
+        } else {
+            formatar_erro_sintatico(canal, sintaticos[j], linhas.posicao(sintaticos[j].offset), canal.interativo, origem);
+            j++;
+        }
+        canal.verificar();
+    }
+    return lexicos.size() + sintaticos.size();
+}
+
+#endif
@@ -0,0 +1,239 @@
+// Compiladores 2025.1 - Tabelas do Analisador Lexico
+//
+// Tabelas geradas em tempo de compilacao (constexpr) usadas pelo Lexer
+// (lexer.h):
+//  - tabela_classes: classe de cada um dos 256 valores de byte
+//  - tabela_transicoes: automato finito sobre estados_maquina x classes_caracteres
+//  - tabela_operadores: tipo de token de cada simbolo simples ou composto
+//  - tabela_reservadas: hash perfeito das palavras reservadas
+//
+// Assim o laco principal do analisador vira apenas consultas a tabelas,
+// sem cadeias de if e sem comparacoes de strings.
+
+#ifndef TABELAS_H
+#define TABELAS_H
+
+#include <array>    // tabelas de tamanho fixo avaliadas em tempo de compilacao
+#include <cstdint>  // uint8_t
+#include <cstddef>  // size_t
+#include <cstring>  // memcmp
+
+// Tipos de classes de caracteres
+enum classes_caracteres : uint8_t {
+    letra, digito, underline, ponto, operador, delimitador,
+    espaco_em_branco, barra, fim_do_arquivo,
+    quebra_linha,   // '\n' (separado dos espacos para contar as linhas)
+    asterisco,      // '*' (operador, mas tambem fecha comentarios)
+    invalido,       // qualquer byte que nao pertence a linguagem
+    total_classes
+};
+
+// Estados possiveis da maquina de estados
+enum estados_maquina : uint8_t {
+    inicio, id, numero, decimal, estado_barra, comentario,
+    estado_operador, estado_delimitador, estado_fim_de_arquivo,
+    comentario_asterisco,   // dentro de um comentario, logo apos um '*'
+    estado_erro,            // caractere invalido lido no inicio de um lexema
+    total_estados
+};
+
+// Tipos de token produzidos pelos analisadores
+enum tipos_token : uint8_t {
+    tk_id, tk_num_int, tk_num_float,
+    // palavras reservadas
+    tk_if, tk_else, tk_while, tk_break, tk_print, tk_readln, tk_return,
+    tk_int, tk_float, tk_char, tk_bool, tk_true, tk_false,
+    // delimitadores
+    tk_lparent, tk_rparent, tk_lbrace, tk_rbrace, tk_semicolon, tk_comma,
+    // operadores
+    tk_mod, tk_assign, tk_eq, tk_plus, tk_increment, tk_minus, tk_decrement,
+    tk_mult, tk_div, tk_lt, tk_leq, tk_gt, tk_geq, tk_or, tk_neg, tk_diff, tk_and,
+    tk_eof,
+    tk_erro,    // simbolo incompleto ('&' ou '|' sozinhos)
+    total_tokens
+};
+
+// Nomes impressos para cada tipo de token (na ordem de tipos_token)
+constexpr const char* nomes_tokens[total_tokens] = {
+    "ID", "NUM", "NUM",
+    "IF", "ELSE", "WHILE", "BREAK", "PRINT", "READLN", "RETURN",
+    "INT", "FLOAT", "CHAR", "BOOL", "TRUE", "FALSE",
+    "LPARENT", "RPARENT", "LBRACE", "RBRACE", "SEMICOLON", "COMMA",
+    "MOD", "ASSIGN", "EQ", "PLUS", "INCREMENT", "MINUS", "DECREMENT",
+    "MULT", "DIV", "LT", "LEQ", "GT", "GEQ", "OR", "NEG", "DIFF", "AND",
+    "EOF",
+    "ERRO"
+};
+
+// Monta a tabela de classes dos 256 bytes (bytes fora da linguagem viram 'invalido')
+constexpr std::array<uint8_t, 256> gerar_tabela_classes(){
+    std::array<uint8_t, 256> t{};
+    for (int i = 0; i < 256; i++) t[i] = invalido;
+    for (int c = 'a'; c <= 'z'; c++) t[c] = letra;
+    for (int c = 'A'; c <= 'Z'; c++) t[c] = letra;
+    for (int c = '0'; c <= '9'; c++) t[c] = digito;
+    t['_'] = underline;
+    t['.'] = ponto;
+    for (char c : {'+', '-', '=', '!', '<', '>', '&', '|'}) t[(unsigned char)c] = operador;
+    t['*'] = asterisco;
+    for (char c : {'(', ')', '{', '}', ';', ',', '%'}) t[(unsigned char)c] = delimitador;
+    for (char c : {' ', '\t', '\r', '\v', '\f'}) t[(unsigned char)c] = espaco_em_branco;
+    t['\n'] = quebra_linha;
+    t['/'] = barra;
+    return t;
+}
+
+constexpr std::array<uint8_t, 256> tabela_classes = gerar_tabela_classes();
+
+// Cada entrada da tabela de transicoes guarda:
+//  bits 0-3: proximo estado (o caractere eh consumido)
+//  bit 7:    aceita - o lexema terminou ANTES deste caractere, que nao eh consumido
+enum bits_transicao : uint8_t {
+    mascara_estado = 0x0f,
+    aceita = 0x80
+};
+
+constexpr std::array<std::array<uint8_t, total_classes>, total_estados> gerar_tabela_transicoes(){
+    std::array<std::array<uint8_t, total_classes>, total_estados> t{};
+
+    // por padrao todo estado termina o lexema no proximo caractere
+    for (auto& linha : t)
+        for (auto& entrada : linha) entrada = aceita;
+
+    // inicio: decide o tipo do lexema pelo primeiro caractere
+    t[inicio][letra] = id;
+    t[inicio][underline] = id;
+    t[inicio][digito] = numero;
+    t[inicio][ponto] = estado_erro;
+    t[inicio][operador] = estado_operador;
+    t[inicio][asterisco] = estado_operador;
+    t[inicio][delimitador] = estado_delimitador;
+    t[inicio][espaco_em_branco] = inicio;
+    t[inicio][quebra_linha] = inicio;
+    t[inicio][barra] = estado_barra;
+    t[inicio][invalido] = estado_erro;
+    t[inicio][fim_do_arquivo] = estado_fim_de_arquivo;
+
+    // identificadores: letras, digitos e '_'
+    t[id][letra] = id;
+    t[id][digito] = id;
+    t[id][underline] = id;
+
+    // numeros: digitos e no maximo um ponto
+    t[numero][digito] = numero;
+    t[numero][ponto] = decimal;
+    t[decimal][digito] = decimal;
+
+    // '/' seguido de '*' abre comentario
+    t[estado_barra][asterisco] = comentario;
+
+    // comentario termina em "*/"
+    for (int classe = 0; classe < total_classes; classe++){
+        if (classe == fim_do_arquivo) continue;
+        t[comentario][classe] = comentario;
+        t[comentario_asterisco][classe] = comentario;
+    }
+    t[comentario][asterisco] = comentario_asterisco;
+    t[comentario_asterisco][asterisco] = comentario_asterisco;
+    t[comentario_asterisco][barra] = inicio;
+
+    return t;
+}
+
+constexpr std::array<std::array<uint8_t, total_classes>, total_estados> tabela_transicoes = gerar_tabela_transicoes();
+
+// Simbolos: token do caractere sozinho e, se existir, o segundo caractere
+// que forma o operador composto (ex.: '<' -> LT, "<=" -> LEQ)
+struct info_simbolo {
+    tipos_token simples;
+    char segundo;
+    tipos_token composto;
+};
+
+constexpr std::array<info_simbolo, 256> gerar_tabela_operadores(){
+    std::array<info_simbolo, 256> t{};
+    for (auto& s : t) s = {tk_erro, 0, tk_erro};
+    t['('] = {tk_lparent, 0, tk_erro};
+    t[')'] = {tk_rparent, 0, tk_erro};
+    t['{'] = {tk_lbrace, 0, tk_erro};
+    t['}'] = {tk_rbrace, 0, tk_erro};
+    t[';'] = {tk_semicolon, 0, tk_erro};
+    t[','] = {tk_comma, 0, tk_erro};
+    t['%'] = {tk_mod, 0, tk_erro};
+    t['*'] = {tk_mult, 0, tk_erro};
+    t['/'] = {tk_div, 0, tk_erro};
+    t['='] = {tk_assign, '=', tk_eq};
+    t['+'] = {tk_plus, '+', tk_increment};
+    t['-'] = {tk_minus, '-', tk_decrement};
+    t['<'] = {tk_lt, '=', tk_leq};
+    t['>'] = {tk_gt, '=', tk_geq};
+    t['!'] = {tk_neg, '=', tk_diff};
+    t['|'] = {tk_erro, '|', tk_or};
+    t['&'] = {tk_erro, '&', tk_and};
+    return t;
+}
+
+constexpr std::array<info_simbolo, 256> tabela_operadores = gerar_tabela_operadores();
+
+// Palavras reservadas da linguagem, na ordem de tipos_token (tk_if ... tk_false)
+constexpr const char* palavras_reservadas[] = {
+    "if", "else", "while", "break", "print", "readln", "return",
+    "int", "float", "char", "bool", "true", "false"
+};
+constexpr int total_reservadas = tk_false - tk_if + 1;
+constexpr size_t menor_reservada = 2;
+constexpr size_t maior_reservada = 6;
+
+constexpr size_t tamanho_literal(const char* s){
+    size_t n = 0;
+    while (s[n] != '\0') n++;
+    return n;
+}
+
+// Hash perfeito das palavras reservadas: primeiro e penultimo caractere mais
+// o tamanho. Os pesos foram escolhidos para que as 13 palavras caiam em
+// posicoes distintas (verificado pelo static_assert abaixo)
+constexpr unsigned hash_reservada(const char* p, size_t n){
+    return (2u * (unsigned char)p[0] + 8u * (unsigned char)p[n - 2] + (unsigned)n) & 31u;
+}
+
+constexpr std::array<uint8_t, 32> gerar_tabela_reservadas(){
+    std::array<uint8_t, 32> t{};
+    for (auto& entrada : t) entrada = tk_id;
+    for (int i = 0; i < total_reservadas; i++){
+        const char* palavra = palavras_reservadas[i];
+        t[hash_reservada(palavra, tamanho_literal(palavra))] = (uint8_t)(tk_if + i);
+    }
+    return t;
+}
+
+constexpr std::array<uint8_t, 32> tabela_reservadas = gerar_tabela_reservadas();
+
+constexpr std::array<uint8_t, total_reservadas> gerar_tamanhos_reservadas(){
+    std::array<uint8_t, total_reservadas> t{};
+    for (int i = 0; i < total_reservadas; i++) t[i] = (uint8_t)tamanho_literal(palavras_reservadas[i]);
+    return t;
+}
+
+// tamanho de cada palavra reservada (compara sem ler alem do literal)
+constexpr std::array<uint8_t, total_reservadas> tamanhos_reservadas = gerar_tamanhos_reservadas();
+
+constexpr bool reservadas_sem_colisao(){
+    int ocupadas = 0;
+    for (uint8_t entrada : tabela_reservadas)
+        if (entrada != tk_id) ocupadas++;
+    return ocupadas == total_reservadas;
+}
+static_assert(reservadas_sem_colisao(), "hash_reservada precisa ser perfeito para as palavras reservadas");
+
+// Tipo do lexema [p, p + n) de um identificador: a palavra reservada
+// correspondente ou tk_id. Nao aloca: um hash e no maximo uma comparacao
+inline tipos_token classificar_palavra(const char* p, size_t n){
+    if (n < menor_reservada || n > maior_reservada) return tk_id;
+    uint8_t tipo = tabela_reservadas[hash_reservada(p, n)];
+    if (tipo == tk_id) return tk_id;
+    if (tamanhos_reservadas[tipo - tk_if] != n || memcmp(palavras_reservadas[tipo - tk_if], p, n) != 0) return tk_id;
+    return (tipos_token)tipo;
+}
+
+#endif
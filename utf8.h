@@ -0,0 +1,60 @@
+// Compiladores 2025.1 - Caracteres UTF-8
+//
+// A linguagem so usa ASCII, mas o texto fonte costuma vir em UTF-8 (letras
+// acentuadas em identificadores, aspas tipograficas coladas de um editor) ou,
+// misturado, em Latin-1. Fora do ASCII o Lexer le um caractere inteiro por
+// vez: um 'é' vira um unico erro, com o caractere todo no lexema, e nao um
+// erro para cada byte.
+//
+// Sequencias invalidas seguem a regra do Unicode do "maior prefixo valido"
+// (maximal subpart): cada trecho invalido vira um erro so, do tamanho do
+// maior prefixo que ainda poderia ter formado um caractere. Sao invalidas as
+// formas sobrelongas (C0 80 para NUL), os surrogates (ED A0..BF) e o que
+// passa de U+10FFFF (F4 90 em diante, F5..FF).
+
+#ifndef UTF8_H
+#define UTF8_H
+
+#include <cstddef>
+
+// Um caractere lido de [p, fim)
+struct SequenciaUtf8 {
+    size_t tamanho;     // bytes do caractere, ou do trecho invalido (pelo menos 1)
+    bool valida;
+    bool incompleta;    // a entrada acabou no meio de uma sequencia que ate ali era valida
+};
+
+// le o caractere que comeca em p (p < fim)
+inline SequenciaUtf8 decodificar_utf8(const char* p, const char* fim){
+    unsigned char primeiro = (unsigned char)*p;
+    if (primeiro < 0x80) return {1, true, false};
+
+    // tamanho pelo primeiro byte; o segundo tem uma faixa mais estreita onde
+    // ela exclui sobrelongas, surrogates e valores acima de U+10FFFF
+    size_t tamanho;
+    unsigned char minimo = 0x80, maximo = 0xbf;
+    if (primeiro >= 0xc2 && primeiro <= 0xdf){
+        tamanho = 2;
+    } else if (primeiro >= 0xe0 && primeiro <= 0xef){
+        tamanho = 3;
+        if (primeiro == 0xe0) minimo = 0xa0;
+        else if (primeiro == 0xed) maximo = 0x9f;
+    } else if (primeiro >= 0xf0 && primeiro <= 0xf4){
+        tamanho = 4;
+        if (primeiro == 0xf0) minimo = 0x90;
+        else if (primeiro == 0xf4) maximo = 0x8f;
+    } else {
+        return {1, false, false};   // continuacao solta, C0, C1 ou F5..FF
+    }
+
+    for (size_t i = 1; i < tamanho; i++){
+        if (p + i == fim) return {i, false, true};
+        unsigned char byte = (unsigned char)p[i];
+        if (byte < minimo || byte > maximo) return {i, false, false};
+        minimo = 0x80;
+        maximo = 0xbf;
+    }
+    return {tamanho, true, false};
+}
+
+#endif
@@ -0,0 +1,271 @@
+// Compiladores 2025.1 - Maquina virtual do bytecode
+//
+// Executa o ProgramaBytecode de bytecode.h. O laco de despacho existe em
+// duas versoes, geradas do mesmo corpo:
+//  - goto computado (GCC e Clang): cada instrucao termina saltando direto
+//    para o rotulo da proxima (goto *rotulos[op]), entao cada uma tem o seu
+//    proprio desvio indireto, que o preditor aprende separadamente
+//  - switch: todas voltam para um unico switch, que eh o unico desvio
+//    indireto do laco (a versao usada onde nao ha goto computado)
+//
+// Os registradores sao um vetor de Valor copiado de registradores_iniciais;
+// os inteiros dao a volta em 64 bits (sem comportamento indefinido) e os
+// unicos erros de execucao sao divisao (ou resto) por zero e entrada
+// invalida em readln.
+
+#ifndef VM_H
+#define VM_H
+
+#include <cstdint>
+#include <istream>
+#include <vector>
+
+#include "bytecode.h"
+#include "saida.h"      // CanalSaida
+
+#if defined(__GNUC__)
+constexpr bool vm_tem_goto = true;
+#else
+constexpr bool vm_tem_goto = false;
+#endif
+
+struct ResultadoExecucao {
+    bool ok = true;
+    int64_t codigo_saida = 0;       // valor do return (0 se o programa chegou ao fim)
+    const char* erro = nullptr;     // mensagem do erro de execucao
+    size_t offset = 0;              // onde o erro aconteceu no fonte
+};
+
+// Mensagens dos erros de execucao (as mesmas no codigo nativo, nativo.h)
+constexpr const char* erro_divisao_zero = "divisão por zero";
+constexpr const char* erro_resto_zero = "resto de divisão por zero";
+constexpr const char* erro_leitura_int = "entrada inválida para readln (esperado um inteiro)";
+constexpr const char* erro_leitura_float = "entrada inválida para readln (esperado um número)";
+
+// double -> int64 truncando, com saturacao (a conversao direta de um valor
+// fora do intervalo, ou NaN, eh indefinida)
+inline int64_t truncar(double valor){
+    if (!(valor == valor)) return 0;
+    if (valor >= 9223372036854775807.0) return INT64_MAX;
+    if (valor <= -9223372036854775808.0) return INT64_MIN;
+    return (int64_t)valor;
+}
+
+// soma, subtracao e multiplicacao que dao a volta em 64 bits
+inline int64_t somar(int64_t a, int64_t b){ return (int64_t)((uint64_t)a + (uint64_t)b); }
+inline int64_t subtrair(int64_t a, int64_t b){ return (int64_t)((uint64_t)a - (uint64_t)b); }
+inline int64_t multiplicar(int64_t a, int64_t b){ return (int64_t)((uint64_t)a * (uint64_t)b); }
+
+template<bool com_goto>
+ResultadoExecucao executar_bytecode(const ProgramaBytecode& programa, CanalSaida& saida, std::istream& entrada){
+    ResultadoExecucao resultado;
+    if (programa.codigo.empty()) return resultado;
+
+    std::vector<Valor> registradores = programa.registradores_iniciais;
+    Valor* r = registradores.data();
+    const Instrucao* codigo = programa.codigo.data();
+    const Instrucao* pc = codigo;
+
+#define FALHAR(mensagem) do {                                       \
+        resultado.ok = false;                                       \
+        resultado.erro = mensagem;                                  \
+        resultado.offset = programa.offsets[(size_t)(pc - codigo)]; \
+        return resultado;                                           \
+    } while (0)
+
+#if defined(__GNUC__)
+    // na mesma ordem de codigos_bytecode
+    static void* const rotulos[total_codigos_bytecode] = {
+        &&r_op_mov,
+        &&r_op_add_i, &&r_op_sub_i, &&r_op_mul_i, &&r_op_div_i, &&r_op_mod_i,
+        &&r_op_add_f, &&r_op_sub_f, &&r_op_mul_f, &&r_op_div_f,
+        &&r_op_neg_i, &&r_op_neg_f, &&r_op_not_i,
+        &&r_op_lt_i, &&r_op_le_i, &&r_op_gt_i, &&r_op_ge_i, &&r_op_eq_i, &&r_op_ne_i,
+        &&r_op_lt_f, &&r_op_le_f, &&r_op_gt_f, &&r_op_ge_f, &&r_op_eq_f, &&r_op_ne_f,
+        &&r_op_i2f, &&r_op_f2i,
+        &&r_op_inc_i, &&r_op_dec_i, &&r_op_inc_f, &&r_op_dec_f,
+        &&r_op_jmp,
+        &&r_op_jz, &&r_op_jnz,
+        &&r_op_jlt_i, &&r_op_jle_i, &&r_op_jgt_i, &&r_op_jge_i, &&r_op_jeq_i, &&r_op_jne_i,
+        &&r_op_print_i, &&r_op_print_f,
+        &&r_op_read_i, &&r_op_read_f,
+        &&r_op_ret
+    };
+#define INSTRUCAO(op) case op: r_##op
+#define PROXIMA() do { if constexpr (com_goto) goto *rotulos[pc->op]; else goto despachar; } while (0)
+    PROXIMA();
+#else
+#define INSTRUCAO(op) case op
+#define PROXIMA() goto despachar
+#endif
+
+#define BINARIA(op, campo, expressao) INSTRUCAO(op): {  \
+        auto a = r[pc->b].campo;                        \
+        auto b = r[pc->c].campo;                        \
+        (void)a; (void)b;                               \
+        expressao;                                      \
+        pc++;                                           \
+        PROXIMA();                                      \
+    }
+#define DESVIO(op, condicao) INSTRUCAO(op): {                   \
+        int64_t a = r[pc->a].i, b = r[pc->b].i;                 \
+        (void)b;                                                \
+        pc = (condicao) ? codigo + pc->c : pc + 1;              \
+        PROXIMA();                                              \
+    }
+
+    // com o goto computado so o primeiro despacho passa pelo switch
+#if defined(__GNUC__)
+despachar: __attribute__((unused));
+#else
+despachar:
+#endif
+    switch ((codigos_bytecode)pc->op){
+        INSTRUCAO(op_mov):
+            r[pc->a] = r[pc->b];
+            pc++;
+            PROXIMA();
+
+        BINARIA(op_add_i, i, r[pc->a].i = somar(a, b))
+        BINARIA(op_sub_i, i, r[pc->a].i = subtrair(a, b))
+        BINARIA(op_mul_i, i, r[pc->a].i = multiplicar(a, b))
+        BINARIA(op_div_i, i, if (b == 0) FALHAR(erro_divisao_zero);
+                             r[pc->a].i = b == -1 ? subtrair(0, a) : a / b)
+        BINARIA(op_mod_i, i, if (b == 0) FALHAR(erro_resto_zero);
+                             r[pc->a].i = b == -1 ? 0 : a % b)
+        BINARIA(op_add_f, f, r[pc->a].f = a + b)
+        BINARIA(op_sub_f, f, r[pc->a].f = a - b)
+        BINARIA(op_mul_f, f, r[pc->a].f = a * b)
+        BINARIA(op_div_f, f, r[pc->a].f = a / b)
+
+        INSTRUCAO(op_neg_i):
+            r[pc->a].i = subtrair(0, r[pc->b].i);
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_neg_f):
+            r[pc->a].f = -r[pc->b].f;
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_not_i):
+            r[pc->a].i = r[pc->b].i == 0;
+            pc++;
+            PROXIMA();
+
+        BINARIA(op_lt_i, i, r[pc->a].i = a < b)
+        BINARIA(op_le_i, i, r[pc->a].i = a <= b)
+        BINARIA(op_gt_i, i, r[pc->a].i = a > b)
+        BINARIA(op_ge_i, i, r[pc->a].i = a >= b)
+        BINARIA(op_eq_i, i, r[pc->a].i = a == b)
+        BINARIA(op_ne_i, i, r[pc->a].i = a != b)
+        BINARIA(op_lt_f, f, r[pc->a].i = a < b)
+        BINARIA(op_le_f, f, r[pc->a].i = a <= b)
+        BINARIA(op_gt_f, f, r[pc->a].i = a > b)
+        BINARIA(op_ge_f, f, r[pc->a].i = a >= b)
+        BINARIA(op_eq_f, f, r[pc->a].i = a == b)
+        BINARIA(op_ne_f, f, r[pc->a].i = a != b)
+
+        INSTRUCAO(op_i2f):
+            r[pc->a].f = (double)r[pc->b].i;
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_f2i):
+            r[pc->a].i = truncar(r[pc->b].f);
+            pc++;
+            PROXIMA();
+
+        INSTRUCAO(op_inc_i):
+            r[pc->a].i = somar(r[pc->a].i, 1);
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_dec_i):
+            r[pc->a].i = subtrair(r[pc->a].i, 1);
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_inc_f):
+            r[pc->a].f += 1;
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_dec_f):
+            r[pc->a].f -= 1;
+            pc++;
+            PROXIMA();
+
+        INSTRUCAO(op_jmp):
+            pc = codigo + pc->a;
+            PROXIMA();
+        INSTRUCAO(op_jz):
+            pc = r[pc->a].i == 0 ? codigo + pc->b : pc + 1;
+            PROXIMA();
+        INSTRUCAO(op_jnz):
+            pc = r[pc->a].i != 0 ? codigo + pc->b : pc + 1;
+            PROXIMA();
+        DESVIO(op_jlt_i, a < b)
+        DESVIO(op_jle_i, a <= b)
+        DESVIO(op_jgt_i, a > b)
+        DESVIO(op_jge_i, a >= b)
+        DESVIO(op_jeq_i, a == b)
+        DESVIO(op_jne_i, a != b)
+
+        INSTRUCAO(op_print_i):
+            saida.escrever_numero(r[pc->a].i);
+            saida.escrever("\n");
+            saida.verificar();
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_print_f):
+            saida.escrever_real(r[pc->a].f);
+            saida.escrever("\n");
+            saida.verificar();
+            pc++;
+            PROXIMA();
+
+        // o que ja foi impresso aparece antes de o programa esperar a entrada
+        INSTRUCAO(op_read_i):
+            saida.descarregar();
+            if (!(entrada >> r[pc->a].i)) FALHAR(erro_leitura_int);
+            pc++;
+            PROXIMA();
+        INSTRUCAO(op_read_f):
+            saida.descarregar();
+            if (!(entrada >> r[pc->a].f)) FALHAR(erro_leitura_float);
+            pc++;
+            PROXIMA();
+
+        INSTRUCAO(op_ret):
+            resultado.codigo_saida = r[pc->a].i;
+            return resultado;
+
+        default:
+            FALHAR("instrução inválida");
+    }
+    return resultado;
+
+#undef DESVIO
+#undef BINARIA
+#undef PROXIMA
+#undef INSTRUCAO
+#undef FALHAR
+}
+
+// executa com o goto computado quando o compilador tem suporte
+inline ResultadoExecucao executar(const ProgramaBytecode& programa, CanalSaida& saida, std::istream& entrada,
+                                  bool com_goto = vm_tem_goto){
+    if (com_goto && vm_tem_goto) return executar_bytecode<true>(programa, saida, entrada);
+    return executar_bytecode<false>(programa, saida, entrada);
+}
+
+// "Encontrado ERRO DE EXECUCAO na linha L, coluna C: divisao por zero"
+inline void formatar_erro_execucao(CanalSaida& canal, const ResultadoExecucao& resultado, PosicaoTexto posicao,
+                                   bool cor){
+    if (cor) canal.escrever("\033[31m");
+    canal.escrever("Encontrado ERRO DE EXECUÇÃO na linha ");
+    canal.escrever_numero(posicao.linha);
+    canal.escrever(", coluna ");
+    canal.escrever_numero(posicao.coluna);
+    canal.escrever(": ");
+    canal.escrever(resultado.erro);
+    if (cor) canal.escrever("\033[0m");
+    canal.escrever("\n");
+}
+
+#endif